@@ -0,0 +1,443 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: animation.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\ppm\ppm.h"
+#include "..\scene\scene.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "..\tilebin\tilebin.h"
+#include "..\stats\stats.h"
+#include "..\raycaster\raycaster.h"
+#include "animation.h"
+
+/**
+ * animation_track
+ *
+ * @param animation - animation being loaded
+ * @param kind - KIND_CAMERA, KIND_SPHERE, or KIND_PLANE
+ * @param object - scene index of the object, -1 for the camera
+ * @param column - index of the object in the render scene columns, -1 for the camera
+ * @returns index of the new track
+ * @description appends an empty track, doubling the track array when it is full
+ */
+static int animation_track(Animation *animation, ObjectKind kind, int object, int column) {
+	Track *track;
+
+	if(animation->num_tracks == animation->max_tracks) {
+		animation->max_tracks = (animation->max_tracks > 0) ? animation->max_tracks * 2 : 16;
+		animation->tracks = realloc(animation->tracks, sizeof(Track) * animation->max_tracks);
+
+		if(animation->tracks == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	track = &animation->tracks[animation->num_tracks];
+	track->kind = kind;
+	track->object = object;
+	track->column = column;
+	track->num_keys = 0;
+	track->max_keys = 0;
+	track->keys = NULL;
+
+	if(kind == KIND_SPHERE) {
+		animation->moves_spheres = 1;
+
+	}
+
+	animation->num_tracks = animation->num_tracks + 1;
+
+	return(animation->num_tracks - 1);
+
+}
+
+
+/**
+ * track_insert
+ *
+ * @param track - track of the keyframe's object
+ * @param frame - frame of the keyframe
+ * @param position - position at that frame
+ * @param entry - index of the keyframe in the motion file, for error messages
+ * @returns void
+ * @description inserts a keyframe keeping the track sorted by frame. Keyframes are usually listed
+ * in order, they are then simply appended.
+ */
+static void track_insert(Track *track, int frame, const double *position, int entry) {
+	int index;
+
+	if(track->num_keys == track->max_keys) {
+		track->max_keys = (track->max_keys > 0) ? track->max_keys * 2 : 8;
+		track->keys = realloc(track->keys, sizeof(Keyframe) * track->max_keys);
+
+		if(track->keys == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	for(index = track->num_keys; (index > 0) && (track->keys[index - 1].frame >= frame); index--) {
+		if(track->keys[index - 1].frame == frame) {
+			fprintf(stderr, "Error, keyframe %d; frame %d of this object already has a keyframe.\n", entry, frame);
+			exit(-1);
+
+		}
+
+		track->keys[index] = track->keys[index - 1];
+
+	}
+
+	track->keys[index].frame = frame;
+	track->keys[index].position[0] = position[0];
+	track->keys[index].position[1] = position[1];
+	track->keys[index].position[2] = position[2];
+	track->num_keys = track->num_keys + 1;
+
+}
+
+
+/**
+ * animation_keyframe
+ *
+ * @param key - keyframe read in from the motion file, only valid during the call
+ * @param entry - position of the keyframe in the motion file
+ * @param context - AnimationLoad
+ * @returns void
+ * @description MotionHandler used by animation_load, inserts each keyframe into the track of the
+ * object it moves
+ */
+static void animation_keyframe(MotionKey *key, int entry, void *context) {
+	AnimationLoad *load = (AnimationLoad *)context;
+	Object *object = &key->object;
+	ObjectKind kind;
+	int column;
+
+	kind = object_kind(object->type);
+
+	if(kind == KIND_CAMERA) {
+		if(load->tracks[load->num_objects] < 0) {
+			load->tracks[load->num_objects] = animation_track(load->animation, KIND_CAMERA, -1, -1);
+
+		}
+
+		track_insert(&load->animation->tracks[load->tracks[load->num_objects]], key->frame, object->properties.camera.position, entry);
+
+	} else if((kind == KIND_SPHERE) || (kind == KIND_PLANE)) {
+		if((key->target < 0) || (key->target >= load->num_objects)) {
+			fprintf(stderr, "Error, keyframe %d; object must name one of the %d objects of the scene.\n", entry, load->num_objects);
+			exit(-1);
+
+		}
+
+		column = (kind == KIND_SPHERE) ? load->spheres[key->target] : load->planes[key->target];
+
+		if(column < 0) {
+			fprintf(stderr, "Error, keyframe %d; object %d of the scene is not a %s.\n", entry, key->target, object->type);
+			exit(-1);
+
+		}
+
+		if(load->tracks[key->target] < 0) {
+			load->tracks[key->target] = animation_track(load->animation, kind, key->target, column);
+
+		}
+
+		track_insert(&load->animation->tracks[load->tracks[key->target]], key->frame,
+			(kind == KIND_SPHERE) ? object->properties.sphere.position : object->properties.plane.position, entry);
+
+	} else {
+		fprintf(stderr, "Error, keyframe %d; keyframes must be of type camera, sphere, or plane.\n", entry);
+		exit(-1);
+
+	}
+
+	load->last = (key->frame > load->last) ? key->frame : load->last;
+
+}
+
+
+/**
+ * animation_load
+ *
+ * @param filename - motion file, a json array of keyframes
+ * @param scene - render scene the keyframes move, its bounding volume hierarchy must already be
+ * built since building it reorders the sphere columns
+ * @param num_objects - number of objects in the scene
+ * @param num_frames - number of frames to render, 0 renders up to the last keyframe
+ * @returns a newly allocated Animation
+ * @description reads a motion file with the json reader's motion grammar. Every keyframe is an
+ * object of type camera, sphere, or plane with a frame and a position, spheres and planes also name
+ * the index of the scene object they move, e.g. {"type": "sphere", "object": 2, "frame": 30,
+ * "position": [0, 1, 8]}.
+ */
+Animation *animation_load(const char *filename, RenderScene *scene, int num_objects, int num_frames) {
+	AnimationLoad load;
+	FILE *fpointer;
+	int index;
+
+	fpointer = fopen(filename, "r");
+
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, could not open motion file.\n");
+		exit(-1);
+
+	}
+
+	load.animation = calloc(1, sizeof(Animation));
+	load.num_objects = num_objects;
+	load.spheres = malloc(sizeof(int) * (num_objects > 0 ? num_objects : 1));
+	load.planes = malloc(sizeof(int) * (num_objects > 0 ? num_objects : 1));
+	load.tracks = malloc(sizeof(int) * (num_objects + 1));
+	load.last = 0;
+
+	if((load.animation == NULL) || (load.spheres == NULL) || (load.planes == NULL) || (load.tracks == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	// Resolve scene indices to render scene columns once, the last entry is the camera's track
+	for(index = 0; index < num_objects; index++) {
+		load.spheres[index] = -1;
+		load.planes[index] = -1;
+
+	}
+
+	for(index = 0; index <= num_objects; index++) {
+		load.tracks[index] = -1;
+
+	}
+
+	for(index = 0; index < scene->num_spheres; index++) {
+		load.spheres[scene->sphere_order[index]] = index;
+
+	}
+
+	for(index = 0; index < scene->num_planes; index++) {
+		load.planes[scene->plane_order[index]] = index;
+
+	}
+
+	json_stream_motion(fpointer, animation_keyframe, &load);
+	fclose(fpointer);
+
+	load.animation->num_frames = (num_frames > 0) ? num_frames : load.last + 1;
+
+	free(load.spheres);
+	free(load.planes);
+	free(load.tracks);
+
+	return load.animation;
+
+}
+
+
+/**
+ * animation_apply
+ *
+ * @param animation - animation
+ * @param scene - render scene, positions of the moving spheres and planes are updated in place
+ * @param frame - frame number
+ * @param origin - receives the camera position at the frame, the origin unless a camera keyframe
+ * moves it
+ * @returns void
+ * @description poses the scene at a frame. The scene has to be prepared again afterwards, and
+ * its bounding volume hierarchy refit when spheres move.
+ */
+void animation_apply(Animation *animation, RenderScene *scene, int frame, double *origin) {
+	Track *track;
+	Keyframe *key;
+	double position[3], blend;
+	int index, axis;
+
+	origin[0] = 0.0;
+	origin[1] = 0.0;
+	origin[2] = 0.0;
+
+	for(index = 0; index < animation->num_tracks; index++) {
+		track = &animation->tracks[index];
+
+		// Find the last keyframe at or before the frame, clamped to the first keyframe
+		for(key = track->keys; (key + 1 < track->keys + track->num_keys) && ((key + 1)->frame <= frame); key++);
+
+		if((frame <= key->frame) || (key + 1 == track->keys + track->num_keys)) {
+			position[0] = key->position[0];
+			position[1] = key->position[1];
+			position[2] = key->position[2];
+
+		} else {
+			blend = (double)(frame - key->frame) / ((key + 1)->frame - key->frame);
+
+			for(axis = 0; axis < 3; axis++) {
+				position[axis] = key->position[axis] + ((key + 1)->position[axis] - key->position[axis]) * blend;
+
+			}
+
+		}
+
+		if(track->kind == KIND_CAMERA) {
+			origin[0] = position[0];
+			origin[1] = position[1];
+			origin[2] = position[2];
+
+		} else if(track->kind == KIND_SPHERE) {
+			scene->sphere_x[track->column] = position[0];
+			scene->sphere_y[track->column] = position[1];
+			scene->sphere_z[track->column] = position[2];
+
+		} else {
+			scene->plane_x[track->column] = position[0];
+			scene->plane_y[track->column] = position[1];
+			scene->plane_z[track->column] = position[2];
+
+		}
+
+	}
+
+}
+
+
+/**
+ * frame_name
+ *
+ * @param output - output file name given on the command line
+ * @param frame - frame number
+ * @returns newly allocated file name of the frame
+ * @description numbers a frame's file, out.ppm becomes out_0000.ppm, out_0001.ppm, and so on
+ */
+static char *frame_name(const char *output, int frame) {
+	char *name;
+	size_t length;
+
+	length = strlen(output);
+	name = malloc(length + 32);
+
+	if(name == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	if((length >= 4) && (strcmp(output + length - 4, ".ppm") == 0)) {
+		length = length - 4;
+
+	}
+
+	sprintf(name, "%.*s_%04d.ppm", (int)length, output, frame);
+
+	return name;
+
+}
+
+
+/**
+ * animation_render
+ *
+ * @param animation - animation
+ * @param scene - prepared render scene, with its double precision geometry
+ * @param image - image buffer every frame is rendered into
+ * @param pool - thread pool rendering the tiles, NULL renders on the calling thread
+ * @param output - output file name, numbered for each frame
+ * @param p3_output - 1 writes ASCII ppm3 frames, 0 ppm6 frames
+ * @param single_precision - 1 renders with the single precision kernels
+ * @returns void
+ * @description renders every frame of the animation in one process. The image buffer, the
+ * render scene's columns, and the bounding volume hierarchy are reused from frame to frame, the
+ * hierarchy is refit around the moved spheres rather than rebuilt. Tile bins are rebuilt for every
+ * frame.
+ */
+void animation_render(Animation *animation, RenderScene *scene, Image *image, ThreadPool *pool, const char *output, int p3_output, int single_precision) {
+	double origin[3];
+	char *name;
+	int frame;
+
+	for(frame = 0; frame < animation->num_frames; frame++) {
+		// Pose the scene and compute the frame's ray constants
+		stats_start(PHASE_SCENE);
+		animation_apply(animation, scene, frame, origin);
+		scene_prepare(scene, origin);
+
+		if(single_precision) {
+			scene_double(scene);
+			scene_single(scene, 0);
+
+		}
+
+		stats_stop(PHASE_SCENE);
+
+		if((animation->moves_spheres) && (scene->bvh != NULL)) {
+			stats_start(PHASE_BVH);
+			bvh_refit(scene->bvh, scene);
+			stats_stop(PHASE_BVH);
+
+		}
+
+		if(scene->bins != NULL) {
+			// Projections move with the camera and the spheres, the tiles are binned again
+			stats_start(PHASE_BVH);
+			tilebin_free(scene->bins);
+			scene->bins = tilebin_build(scene, image->width, image->height, TILE_SIZE);
+			stats_stop(PHASE_BVH);
+
+		}
+
+		// Pixels without a hit are never written, the previous frame must not show through
+		stats_start(PHASE_RENDER);
+		memset(image->image_data, 0, sizeof(Pixel) * image->width * image->height);
+		raycaster(scene, image, pool);
+		stats_stop(PHASE_RENDER);
+
+		name = frame_name(output, frame);
+		stats_start(PHASE_WRITE);
+
+		if(p3_output) {
+			write_p3_image_parallel(name, image, pool);
+
+		} else {
+			write_p6_image(name, image);
+
+		}
+
+		stats_stop(PHASE_WRITE);
+		printf("- FRAME %d OF %d: %s -\n", frame + 1, animation->num_frames, name);
+		free(name);
+
+	}
+
+}
+
+
+/**
+ * animation_free
+ *
+ * @param animation - animation loaded by animation_load
+ * @returns void
+ * @description releases an animation and its tracks
+ */
+void animation_free(Animation *animation) {
+	int index;
+
+	for(index = 0; index < animation->num_tracks; index++) {
+		free(animation->tracks[index].keys);
+
+	}
+
+	free(animation->tracks);
+	free(animation);
+
+}
@@ -0,0 +1,77 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: animation.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef animation_h
+#define animation_h
+
+/**
+ * Keyframe
+ *
+ * @description position of an object, or of the camera, at one frame
+ */
+typedef struct Keyframe {
+	int frame;
+	double position[3];
+
+} Keyframe;
+
+
+/**
+ * Track
+ *
+ * @description keyframes of one moving object sorted by frame. object is the index of the object
+ * in the scene and column its index in the render scene's sphere or plane columns, both are -1
+ * for the camera. Between two keyframes the position is interpolated linearly, before the first
+ * and after the last keyframe it holds still.
+ */
+typedef struct Track {
+	ObjectKind kind;
+	int object, column;
+	int num_keys, max_keys;
+	Keyframe *keys;
+
+} Track;
+
+
+/**
+ * Animation
+ *
+ * @description the tracks of a motion file and the number of frames rendered. moves_spheres is
+ * 1 when any sphere moves, the bounding volume hierarchy only needs a refit then.
+ */
+typedef struct Animation {
+	int num_frames;
+	int num_tracks, max_tracks;
+	int moves_spheres;
+	Track *tracks;
+
+} Animation;
+
+/**
+ * AnimationLoad
+ *
+ * @description an animation whose motion file is being read. spheres and planes map each scene
+ * index to its render scene column, -1 when the object is not of that kind, tracks maps each scene
+ * index to its track and its last entry is the camera's track, -1 while there is none. last is
+ * the latest frame of any keyframe read so far.
+ */
+typedef struct AnimationLoad {
+	Animation *animation;
+	int num_objects;
+	int *spheres, *planes, *tracks;
+	int last;
+
+} AnimationLoad;
+
+// function declarations
+Animation *animation_load(const char *filename, RenderScene *scene, int num_objects, int num_frames);
+void animation_apply(Animation *animation, RenderScene *scene, int frame, double *origin);
+void animation_render(Animation *animation, RenderScene *scene, Image *image, ThreadPool *pool, const char *output, int p3_output, int single_precision);
+void animation_free(Animation *animation);
+
+#endif
@@ -0,0 +1,127 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: arena.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "arena.h"
+
+// Every allocation is aligned for any scalar or vector type the program stores
+#define ARENA_ALIGN 16
+
+// Size of a block header rounded up so the first allocation is aligned
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+/**
+ * arena_init
+ *
+ * @param arena - arena to initialize
+ * @param block_size - size of the blocks carved into allocations, 0 selects ARENA_BLOCK_SIZE
+ * @returns void
+ * @description prepares an empty arena, no memory is reserved until the first allocation
+ */
+void arena_init(Arena *arena, size_t block_size) {
+	arena->head = NULL;
+	arena->block_size = (block_size > 0) ? block_size : ARENA_BLOCK_SIZE;
+	arena->allocated = 0;
+
+}
+
+
+/**
+ * arena_alloc
+ *
+ * @param arena - arena to allocate from
+ * @param size - number of bytes
+ * @returns pointer to size bytes aligned to 16 bytes, the memory is not cleared
+ * @description bump allocates from the current block. Requests larger than a quarter block get a
+ * block of their own, placed behind the current block so the current block keeps filling up.
+ */
+void *arena_alloc(Arena *arena, size_t size) {
+	ArenaBlock *block;
+	size_t capacity;
+	void *pointer;
+
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	if((arena->head != NULL) && (arena->head->size - arena->head->used >= size)) {
+		pointer = (char *)arena->head + ARENA_HEADER + arena->head->used;
+		arena->head->used = arena->head->used + size;
+		return pointer;
+
+	}
+
+	capacity = (size > arena->block_size / 4) ? size : arena->block_size;
+	block = malloc(ARENA_HEADER + capacity);
+
+	if(block == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	block->size = capacity;
+	block->used = size;
+	arena->allocated = arena->allocated + ARENA_HEADER + capacity;
+
+	if((capacity == size) && (arena->head != NULL)) {
+		// Dedicated block, keep bump allocating from the current one
+		block->next = arena->head->next;
+		arena->head->next = block;
+
+	} else {
+		block->next = arena->head;
+		arena->head = block;
+
+	}
+
+	return (char *)block + ARENA_HEADER;
+
+}
+
+
+/**
+ * arena_strdup
+ *
+ * @param arena - arena to allocate from
+ * @param string - null terminated string
+ * @returns copy of the string owned by the arena
+ * @description arena counterpart of strdup
+ */
+char *arena_strdup(Arena *arena, const char *string) {
+	size_t length = strlen(string) + 1;
+	char *copy = arena_alloc(arena, length);
+
+	memcpy(copy, string, length);
+
+	return copy;
+
+}
+
+
+/**
+ * arena_release
+ *
+ * @param arena - arena to release
+ * @returns void
+ * @description frees every block of the arena, every pointer it handed out becomes invalid. The
+ * arena is left empty and may be used again.
+ */
+void arena_release(Arena *arena) {
+	ArenaBlock *block, *next;
+
+	for(block = arena->head; block != NULL; block = next) {
+		next = block->next;
+		free(block);
+
+	}
+
+	arena->head = NULL;
+	arena->allocated = 0;
+
+}
@@ -0,0 +1,49 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: arena.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef arena_h
+#define arena_h
+
+#include <stddef.h>
+
+// Default size of the blocks an arena carves allocations from
+#define ARENA_BLOCK_SIZE (1 << 20)
+
+/**
+ * ArenaBlock
+ *
+ * @description header of one block of arena memory, the usable bytes follow the header
+ */
+typedef struct ArenaBlock {
+	struct ArenaBlock *next;
+	size_t size;
+	size_t used;
+
+} ArenaBlock;
+
+
+/**
+ * Arena
+ *
+ * @description bump allocator. Allocations are carved sequentially out of large blocks and are
+ * never freed one at a time, arena_release returns every block at once.
+ */
+typedef struct Arena {
+	ArenaBlock *head;
+	size_t block_size;
+	size_t allocated;
+
+} Arena;
+
+// function declarations
+void arena_init(Arena *arena, size_t block_size);
+void *arena_alloc(Arena *arena, size_t size);
+char *arena_strdup(Arena *arena, const char *string);
+void arena_release(Arena *arena);
+
+#endif
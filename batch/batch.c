@@ -0,0 +1,276 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: batch.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\ppm\ppm.h"
+#include "..\scene\scene.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "..\tilebin\tilebin.h"
+#include "..\stats\stats.h"
+#include "..\raycaster\raycaster.h"
+#include "batch.h"
+
+/**
+ * batch_load
+ *
+ * @param batch - batch
+ * @param job - job whose input is loaded
+ * @returns void
+ * @description reads a json or binary scene file with scene_load and bins it for the job's image
+ * size with --bin. The hierarchy is built on the parser thread alone, the thread pool is busy
+ * rendering the previous job.
+ */
+static void batch_load(Batch *batch, BatchJob *job) {
+	FILE *fpointer;
+
+	// Name the manifest line of a missing scene, scene_load only reports the file
+	fpointer = fopen(job->input, "r");
+
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, manifest line %d; could not open file '%s'.\n", job->number, job->input);
+		exit(-1);
+
+	}
+
+	fclose(fpointer);
+	job->scene = scene_load(job->input, &batch->scene, NULL, &job->num_objects);
+
+	if(job->num_objects <= 0) {
+		return;
+
+	}
+
+	if(batch->use_bins) {
+		stats_start(PHASE_BVH);
+		job->scene->bins = tilebin_build(job->scene, job->width, job->height, TILE_SIZE);
+		stats_stop(PHASE_BVH);
+
+	}
+
+	batch->num_objects = batch->num_objects + job->num_objects;
+	batch->num_spheres = batch->num_spheres + job->scene->num_spheres;
+	batch->num_planes = batch->num_planes + job->scene->num_planes;
+
+}
+
+
+/**
+ * batch_parser
+ *
+ * @param arg - Batch
+ * @returns NULL
+ * @description parser thread, reads the manifest one line at a time and queues every loaded scene
+ * for the renderer. Blank lines and lines starting with # are skipped, an empty scene is skipped
+ * with a note just as raycast renders nothing for it.
+ */
+static void *batch_parser(void *arg) {
+	Batch *batch = (Batch *)arg;
+	char line[BATCH_LINE_SIZE], extra[2];
+	BatchJob *job;
+	int number, length;
+
+	number = 0;
+
+	while(fgets(line, BATCH_LINE_SIZE, batch->manifest) != NULL) {
+		number = number + 1;
+		length = strlen(line);
+
+		if((length == BATCH_LINE_SIZE - 1) && (line[length - 1] != '\n')) {
+			fprintf(stderr, "Error, manifest line %d; line is longer than %d characters.\n", number, BATCH_LINE_SIZE - 2);
+			exit(-1);
+
+		}
+
+		if(((int)strspn(line, " \t\r\n") == length) || (line[strspn(line, " \t")] == '#')) {
+			continue;
+
+		}
+
+		job = malloc(sizeof(BatchJob));
+
+		if(job == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		job->number = number;
+		job->scene = NULL;
+		job->buffer = NULL;
+
+		if((sscanf(line, "%d %d %4095s %4095s %1s", &job->width, &job->height, job->input, job->output, extra) != 4) ||
+			(job->width <= 0) || (job->height <= 0)) {
+			fprintf(stderr, "Error, manifest line %d; expected width height input.json output.ppm.\n", number);
+			exit(-1);
+
+		}
+
+		batch_load(batch, job);
+
+		if(job->num_objects <= 0) {
+			printf("- JOB %d: %s HAS NO OBJECTS, SKIPPED -\n", job->number, job->input);
+			scene_free(job->scene);
+			free(job);
+			continue;
+
+		}
+
+		queue_push(batch->parsed, job);
+
+	}
+
+	queue_close(batch->parsed);
+
+	return NULL;
+
+}
+
+
+/**
+ * batch_writer
+ *
+ * @param arg - Batch
+ * @returns NULL
+ * @description writer thread, writes the rendered images in manifest order and hands every
+ * written framebuffer back to the renderer
+ */
+static void *batch_writer(void *arg) {
+	Batch *batch = (Batch *)arg;
+	BatchJob *job;
+
+	while((job = queue_pop(batch->rendered)) != NULL) {
+		stats_start(PHASE_WRITE);
+
+		if(batch->p3_output) {
+			write_p3_image(job->output, &job->buffer->image);
+
+		} else {
+			write_p6_image(job->output, &job->buffer->image);
+
+		}
+
+		stats_stop(PHASE_WRITE);
+		printf("- JOB %d: %s -\n", job->number, job->output);
+
+		queue_push(batch->free, job->buffer);
+		free(job);
+
+	}
+
+	return NULL;
+
+}
+
+
+/**
+ * batch_render
+ *
+ * @param manifest - manifest file, one job per line: width height input.json output.ppm
+ * @param pool - thread pool rendering the tiles, NULL renders on the calling thread
+ * @param options - how every job's scene file is read by scene_load
+ * @param use_bins - 1 bins the spheres of every scene into screen tiles of the job's image size
+ * @param p3_output - 1 writes ASCII ppm3 images, 0 ppm6 images
+ * @returns number of images written
+ * @description renders every job of a manifest in one process. Parsing, rendering, and writing run
+ * on their own threads connected by bounded queues, so the next scene is read and the previous
+ * image written while the current one renders. Framebuffers are reused from job to job. A job
+ * that fails stops the batch with the error raycast would report for it.
+ */
+int batch_render(const char *manifest, ThreadPool *pool, SceneOptions *options, int use_bins, int p3_output) {
+	Batch batch;
+	BatchBuffer *buffer;
+	BatchJob *job;
+	int index;
+
+	memset(&batch, 0, sizeof(Batch));
+	batch.manifest = fopen(manifest, "r");
+
+	if(batch.manifest == NULL) {
+		fprintf(stderr, "Error, could not open manifest file.\n");
+		exit(-1);
+
+	}
+
+	batch.scene = *options;
+	batch.use_bins = use_bins;
+	batch.p3_output = p3_output;
+	batch.pool = pool;
+	batch.parsed = queue_create(BATCH_SCENES);
+	batch.rendered = queue_create(BATCH_BUFFERS);
+	batch.free = queue_create(BATCH_BUFFERS);
+
+	for(index = 0; index < BATCH_BUFFERS; index++) {
+		batch.buffers[index].image.max_color = 255;
+		queue_push(batch.free, &batch.buffers[index]);
+
+	}
+
+	if((pthread_create(&batch.parser, NULL, batch_parser, &batch) != 0) || (pthread_create(&batch.writer, NULL, batch_writer, &batch) != 0)) {
+		fprintf(stderr, "Error, unable to create batch threads.\n");
+		exit(-1);
+
+	}
+
+	// Render stage, takes a parsed scene and a written framebuffer and passes the image on
+	while((job = queue_pop(batch.parsed)) != NULL) {
+		buffer = queue_pop(batch.free);
+
+		if(job->width * job->height > buffer->capacity) {
+			buffer->image.image_data = realloc(buffer->image.image_data, sizeof(Pixel) * job->width * job->height);
+
+			if(buffer->image.image_data == NULL) {
+				fprintf(stderr, "Failed to allocate memory.\n");
+				exit(-1);
+
+			}
+
+			buffer->capacity = job->width * job->height;
+
+		}
+
+		// Pixels without a hit are never written, the previous job must not show through
+		stats_start(PHASE_RENDER);
+		buffer->image.width = job->width;
+		buffer->image.height = job->height;
+		memset(buffer->image.image_data, 0, sizeof(Pixel) * job->width * job->height);
+		raycaster(job->scene, &buffer->image, pool);
+		stats_stop(PHASE_RENDER);
+
+		scene_free(job->scene);
+		job->scene = NULL;
+		job->buffer = buffer;
+		batch.num_jobs = batch.num_jobs + 1;
+		queue_push(batch.rendered, job);
+
+	}
+
+	queue_close(batch.rendered);
+	pthread_join(batch.parser, NULL);
+	pthread_join(batch.writer, NULL);
+
+	for(index = 0; index < BATCH_BUFFERS; index++) {
+		free(batch.buffers[index].image.image_data);
+
+	}
+
+	queue_destroy(batch.parsed);
+	queue_destroy(batch.rendered);
+	queue_destroy(batch.free);
+	fclose(batch.manifest);
+
+	stats_print(stderr, batch.num_objects, batch.num_spheres, batch.num_planes, (pool != NULL) ? pool->num_threads : 1);
+
+	return batch.num_jobs;
+
+}
@@ -0,0 +1,74 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: batch.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef batch_h
+#define batch_h
+
+#include <pthread.h>
+
+// Longest manifest line, the line feed included
+#define BATCH_LINE_SIZE 4096
+
+// Parsed scenes waiting for the renderer, bounds the scenes held in memory
+#define BATCH_SCENES 2
+
+// Framebuffers cycled between the renderer and the writer, one rendering, one writing, one spare
+#define BATCH_BUFFERS 3
+
+/**
+ * BatchBuffer
+ *
+ * @description framebuffer reused from job to job, capacity is the number of pixels it holds
+ */
+typedef struct BatchBuffer {
+	Image image;
+	int capacity;
+
+} BatchBuffer;
+
+
+/**
+ * BatchJob
+ *
+ * @description one line of the manifest on its way through the pipeline. The parser fills in the
+ * prepared scene, the renderer releases it and hands the rendered buffer on to the writer.
+ */
+typedef struct BatchJob {
+	int number;
+	int width, height;
+	char input[BATCH_LINE_SIZE], output[BATCH_LINE_SIZE];
+	int num_objects;
+	RenderScene *scene;
+	BatchBuffer *buffer;
+
+} BatchJob;
+
+
+/**
+ * Batch
+ *
+ * @description a manifest rendered by three stages. The parser thread reads scenes into the parsed
+ * queue, the calling thread renders them with the thread pool into the rendered queue, and the
+ * writer thread writes the images and returns their buffers through the free queue.
+ */
+typedef struct Batch {
+	FILE *manifest;
+	SceneOptions scene;
+	int use_bins, p3_output;
+	ThreadPool *pool;
+	Queue *parsed, *rendered, *free;
+	BatchBuffer buffers[BATCH_BUFFERS];
+	pthread_t parser, writer;
+	int num_jobs, num_objects, num_spheres, num_planes;
+
+} Batch;
+
+// function declarations
+int batch_render(const char *manifest, ThreadPool *pool, SceneOptions *options, int use_bins, int p3_output);
+
+#endif
@@ -0,0 +1,623 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: bench.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\ppm\ppm.h"
+#include "..\scene\scene.h"
+#include "..\simd\simd.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "..\raycaster\raycaster.h"
+#include "..\microbench\microbench.h"
+#include "bench.h"
+
+// Image resolutions of the full matrix and of a quick run
+static const int bench_resolutions[][2] = {{320, 240}, {640, 480}, {1920, 1080}};
+static const int quick_resolutions[][2] = {{160, 120}};
+
+// Sphere counts of the full matrix and of a quick run
+static const int bench_spheres[] = {16, 256, 4096, 65536};
+static const int quick_spheres[] = {16, 256};
+
+/**
+ * bench_random
+ *
+ * @param state - generator state, never 0
+ * @returns a pseudo random number in [0, 1)
+ * @description xorshift generator, the same seed gives the same scene on every platform
+ */
+static double bench_random(unsigned int *state) {
+	unsigned int x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return((x >> 8) / 16777216.0);
+
+}
+
+
+/**
+ * bench_offset
+ *
+ * @param state - generator state, never 0
+ * @returns a pseudo random number in [-1.5, 1.5)
+ * @description sum of three uniform numbers, bunched toward 0
+ */
+static double bench_offset(unsigned int *state) {
+	double offset;
+
+	offset = bench_random(state);
+	offset = offset + bench_random(state);
+	offset = offset + bench_random(state);
+
+	return(offset - 1.5);
+
+}
+
+
+/**
+ * bench_layout_name
+ *
+ * @param layout - scene layout
+ * @returns the name of the layout
+ * @description names a layout for the report
+ */
+const char *bench_layout_name(BenchLayout layout) {
+	if(layout == LAYOUT_CLUSTERED) {
+		return("clustered");
+
+	} else if(layout == LAYOUT_STACKED) {
+		return("stacked");
+
+	}
+
+	return("uniform");
+
+}
+
+
+/**
+ * write_sphere
+ *
+ * @param fpointer - json scene being written
+ * @param state - generator state
+ * @param x - position of the sphere
+ * @param y - position of the sphere
+ * @param z - position of the sphere
+ * @param radius - radius of the sphere
+ * @returns void
+ * @description writes one sphere object with a random color
+ */
+static void write_sphere(FILE *fpointer, unsigned int *state, double x, double y, double z, double radius) {
+	double red, green, blue;
+
+	red = bench_random(state);
+	green = bench_random(state);
+	blue = bench_random(state);
+
+	fprintf(fpointer, ",\n {\n    \"type\": \"sphere\",\n    \"color\": [%f, %f, %f],\n", red, green, blue);
+	fprintf(fpointer, "    \"position\": [%f, %f, %f],\n    \"radius\": %f\n }", x, y, z, radius);
+
+}
+
+
+/**
+ * bench_generate
+ *
+ * @param filename - json scene file to write
+ * @param layout - how the spheres are placed
+ * @param num_spheres - number of spheres
+ * @param num_planes - number of planes, the first is a floor and the second a back wall
+ * @param seed - seed of the generator, mixed with the layout and sphere count
+ * @returns void
+ * @description writes a camera followed by the spheres and planes of a synthetic scene. Every
+ * sphere lies inside the view between BENCH_NEAR and BENCH_FAR, with radii scaled to the number
+ * of spheres so the scenes stay about equally busy as they grow. The same arguments always write
+ * the same file.
+ */
+void bench_generate(const char *filename, BenchLayout layout, int num_spheres, int num_planes, unsigned int seed) {
+	FILE *fpointer;
+	unsigned int state;
+	double centers[BENCH_CLUSTERS][3];
+	double x, y, z, scale, spread, nx, ny, nz, red, green, blue;
+	int index, columns, layers, grid, column;
+
+	fpointer = fopen(filename, "w");
+
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, could not open file.\n");
+		exit(-1);
+
+	}
+
+	state = seed ^ ((unsigned int)layout * 0x9E3779B9u) ^ ((unsigned int)num_spheres * 0x85EBCA6Bu);
+	state = (state != 0) ? state : 1;
+
+	fprintf(fpointer, "[\n {\n    \"type\": \"camera\",\n    \"width\": 1.0,\n    \"height\": 1.0\n }");
+
+	if(layout == LAYOUT_UNIFORM) {
+		// Radius from the view volume each sphere gets, the view is as wide as it is deep
+		scale = 0.15 * cbrt((pow(BENCH_FAR, 3) - pow(BENCH_NEAR, 3)) / 3.0 / num_spheres);
+
+		for(index = 0; index < num_spheres; index++) {
+			z = BENCH_NEAR + (BENCH_FAR - BENCH_NEAR) * bench_random(&state);
+			x = (bench_random(&state) - 0.5) * z;
+			y = (bench_random(&state) - 0.5) * z;
+			write_sphere(fpointer, &state, x, y, z, scale * (0.5 + bench_random(&state)));
+
+		}
+
+	} else if(layout == LAYOUT_CLUSTERED) {
+		spread = (BENCH_FAR - BENCH_NEAR) / 16.0;
+		scale = 0.5 * cbrt(pow(2.0 * spread, 3) * BENCH_CLUSTERS / num_spheres);
+
+		for(index = 0; index < BENCH_CLUSTERS; index++) {
+			centers[index][2] = BENCH_NEAR + 2.0 * spread + (BENCH_FAR - BENCH_NEAR - 4.0 * spread) * bench_random(&state);
+			centers[index][0] = (bench_random(&state) - 0.5) * 0.8 * centers[index][2];
+			centers[index][1] = (bench_random(&state) - 0.5) * 0.8 * centers[index][2];
+
+		}
+
+		for(index = 0; index < num_spheres; index++) {
+			column = index % BENCH_CLUSTERS;
+			x = centers[column][0] + bench_offset(&state) * spread;
+			y = centers[column][1] + bench_offset(&state) * spread;
+			z = centers[column][2] + bench_offset(&state) * spread;
+			write_sphere(fpointer, &state, x, y, z, scale * (0.5 + bench_random(&state)));
+
+		}
+
+	} else {
+		// Columns of spheres along the view direction, each sphere covers the same screen area
+		layers = (int)ceil(sqrt((double)num_spheres));
+		columns = (num_spheres + layers - 1) / layers;
+		grid = (int)ceil(sqrt((double)columns));
+
+		for(index = 0; index < num_spheres; index++) {
+			column = index % columns;
+			z = BENCH_NEAR + (BENCH_FAR - BENCH_NEAR) * ((index / columns) + 0.5) / layers;
+			x = (((column % grid) + 0.5) / grid - 0.5) * z;
+			y = (((column / grid) + 0.5) / grid - 0.5) * z;
+			write_sphere(fpointer, &state, x, y, z, z * (0.3 + 0.2 * bench_random(&state)) / grid);
+
+		}
+
+	}
+
+	for(index = 0; index < num_planes; index++) {
+		if(index == 0) {
+			x = 0;
+			y = -BENCH_NEAR;
+			z = 0;
+			nx = 0;
+			ny = 1;
+			nz = 0;
+
+		} else if(index == 1) {
+			x = 0;
+			y = 0;
+			z = BENCH_FAR + BENCH_NEAR;
+			nx = 0;
+			ny = 0;
+			nz = -1;
+
+		} else {
+			x = 0;
+			y = 0;
+			z = BENCH_FAR + BENCH_NEAR * index;
+			nx = bench_random(&state) - 0.5;
+			ny = bench_random(&state) - 0.5;
+			nz = -1;
+
+		}
+
+		red = bench_random(&state);
+		green = bench_random(&state);
+		blue = bench_random(&state);
+
+		fprintf(fpointer, ",\n {\n    \"type\": \"plane\",\n    \"color\": [%f, %f, %f],\n", red, green, blue);
+		fprintf(fpointer, "    \"position\": [%f, %f, %f],\n    \"normal\": [%f, %f, %f]\n }", x, y, z, nx, ny, nz);
+
+	}
+
+	fprintf(fpointer, "\n]\n");
+	fclose(fpointer);
+
+}
+
+
+/**
+ * bench_now
+ *
+ * @returns milliseconds on a monotonic clock
+ * @description reads the clock the phases are timed with
+ */
+static double bench_now(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return(now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0);
+
+}
+
+
+/**
+ * bench_case
+ *
+ * @param scene_file - json scene to render
+ * @param image_file - ppm6 image to write
+ * @param width - width of the image in pixels
+ * @param height - height of the image in pixels
+ * @param use_bvh - build a bounding volume hierarchy over the spheres
+ * @param num_threads - render threads, 1 renders on the calling thread
+ * @param repeat - number of times the pipeline is run
+ * @param result - timings of the case, the fastest run of each phase
+ * @returns void
+ * @description runs the whole parse, build, render, and write pipeline repeat times
+ */
+static void bench_case(const char *scene_file, const char *image_file, int width, int height, int use_bvh, int num_threads, int repeat, BenchResult *result) {
+	FILE *fpointer;
+	Scene objects;
+	RenderScene *scene;
+	ThreadPool *pool;
+	Image image;
+	double start, parsed, built, rendered, written;
+	double origin[3] = {0.0, 0.0, 0.0};
+	int count;
+
+	pool = (num_threads > 1) ? threadpool_create(num_threads) : NULL;
+
+	image.width = width;
+	image.height = height;
+	image.max_color = 255;
+	image.image_data = malloc(sizeof(Pixel) * width * height);
+
+	if(image.image_data == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(count = 0; count < repeat; count++) {
+		start = bench_now();
+
+		fpointer = fopen(scene_file, "r");
+
+		if(fpointer == NULL) {
+			fprintf(stderr, "Error, could not open file.\n");
+			exit(-1);
+
+		}
+
+		scene_init(&objects);
+		json_read_scene(fpointer, &objects);
+		fclose(fpointer);
+		scene = scene_build(&objects);
+		scene_release(&objects);
+		scene_prepare(scene, origin);
+		parsed = bench_now();
+
+		if(use_bvh) {
+			scene->bvh = bvh_build(scene, pool);
+
+		}
+
+		built = bench_now();
+		raycaster(scene, &image, pool);
+		rendered = bench_now();
+		write_p6_image((char *)image_file, &image);
+		written = bench_now();
+
+		scene_free(scene);
+
+		if((count == 0) || (parsed - start < result->parse_ms)) {
+			result->parse_ms = parsed - start;
+
+		}
+
+		if((count == 0) || (built - parsed < result->build_ms)) {
+			result->build_ms = built - parsed;
+
+		}
+
+		if((count == 0) || (rendered - built < result->render_ms)) {
+			result->render_ms = rendered - built;
+
+		}
+
+		if((count == 0) || (written - rendered < result->write_ms)) {
+			result->write_ms = written - rendered;
+
+		}
+
+		if((count == 0) || (written - start < result->total_ms)) {
+			result->total_ms = written - start;
+
+		}
+
+	}
+
+	free(image.image_data);
+
+	if(pool != NULL) {
+		threadpool_destroy(pool);
+
+	}
+
+}
+
+
+/**
+ * bench_fork
+ *
+ * @param scene_file - json scene to render
+ * @param image_file - ppm6 image to write
+ * @param width - width of the image in pixels
+ * @param height - height of the image in pixels
+ * @param use_bvh - build a bounding volume hierarchy over the spheres
+ * @param num_threads - render threads
+ * @param repeat - number of times the pipeline is run
+ * @param result - timings and peak resident set size of the case
+ * @returns void
+ * @description runs a case in a child process so its peak resident set size is its own, the
+ * timings come back through a pipe and the peak from the child's resource usage. result->failed
+ * is set when the child does not finish.
+ */
+static void bench_fork(const char *scene_file, const char *image_file, int width, int height, int use_bvh, int num_threads, int repeat, BenchResult *result) {
+	struct rusage usage;
+	int descriptors[2], status;
+	pid_t child;
+
+	memset(result, 0, sizeof(BenchResult));
+
+	if(pipe(descriptors) != 0) {
+		fprintf(stderr, "Error, could not create a pipe.\n");
+		exit(-1);
+
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	child = fork();
+
+	if(child < 0) {
+		fprintf(stderr, "Error, could not start a benchmark process.\n");
+		exit(-1);
+
+	} else if(child == 0) {
+		close(descriptors[0]);
+		bench_case(scene_file, image_file, width, height, use_bvh, num_threads, repeat, result);
+
+		if(write(descriptors[1], result, sizeof(BenchResult)) != sizeof(BenchResult)) {
+			_exit(-1);
+
+		}
+
+		_exit(0);
+
+	}
+
+	close(descriptors[1]);
+
+	if(read(descriptors[0], result, sizeof(BenchResult)) != sizeof(BenchResult)) {
+		result->failed = 1;
+
+	}
+
+	close(descriptors[0]);
+
+	if((wait4(child, &status, 0, &usage) != child) || (!WIFEXITED(status)) || (WEXITSTATUS(status) != 0)) {
+		result->failed = 1;
+
+	} else {
+		result->peak_rss = usage.ru_maxrss;
+
+	}
+
+}
+
+
+/**
+ * parse_count
+ *
+ * @param argc - number of arguments
+ * @param argv - arguments
+ * @param index - index of the option, the count follows it
+ * @param option - option name for the error message
+ * @returns the non-negative integer following the option
+ * @description reads the integer argument of an option, exits when it is missing or malformed
+ */
+static int parse_count(int argc, char *argv[], int index, const char *option) {
+	if((index + 1 >= argc) || (strlen(argv[index + 1]) == 0) || (strspn(argv[index + 1], "0123456789") != strlen(argv[index + 1]))) {
+		fprintf(stderr, "Error, %s expects a non-negative integer.\n", option);
+		exit(-1);
+
+	}
+
+	return(atoi(argv[index + 1]));
+
+}
+
+
+/**
+ * main
+ *
+ * @param argc - contains the number of arguments passed to the program
+ * @param argv - a one-dimensional array of strings
+ * @returns 0 upon successful completion
+ * @description generates the synthetic scenes and runs every layout, sphere count, and resolution
+ * of the matrix through the pipeline, or with --kernels times the intersection kernels on their
+ * own. The report is written to stdout as json, progress to stderr.
+ */
+int main(int argc, char *argv[]) {
+	const int (*resolutions)[2];
+	const int *spheres;
+	char scene_file[1024], image_file[1024];
+	const char *directory;
+	int num_resolutions, num_spheres, num_threads, use_bvh, repeat, quick, max_spheres, first;
+	int kernels, warmup;
+	int index, layout, sphere, resolution;
+	unsigned int seed;
+	SimdLevel simd_level;
+	BenchResult result;
+	double rays;
+
+	num_threads = 1;
+	simd_level = SIMD_AVX512;
+	use_bvh = 1;
+	seed = 1;
+	repeat = 0;
+	quick = 0;
+	kernels = 0;
+	warmup = 3;
+	max_spheres = 0;
+	directory = ".";
+
+	for(index = 1; index < argc; index++) {
+		if(strcmp(argv[index], "--threads") == 0) {
+			// Thread count, 0 selects one thread per online processor
+			num_threads = parse_count(argc, argv, index, "--threads");
+			num_threads = (num_threads == 0) ? threadpool_default_threads() : num_threads;
+			index = index + 1;
+
+		} else if(strcmp(argv[index], "--simd") == 0) {
+			if((index + 1 >= argc) || (simd_parse_level(argv[index + 1], &simd_level) == 0)) {
+				fprintf(stderr, "Error, --simd expects one of scalar, sse2, avx2, or avx512.\n");
+				exit(-1);
+
+			}
+
+			index = index + 1;
+
+		} else if(strcmp(argv[index], "--no-bvh") == 0) {
+			use_bvh = 0;
+
+		} else if(strcmp(argv[index], "--seed") == 0) {
+			seed = (unsigned int)parse_count(argc, argv, index, "--seed");
+			index = index + 1;
+
+		} else if(strcmp(argv[index], "--repeat") == 0) {
+			repeat = parse_count(argc, argv, index, "--repeat");
+			repeat = (repeat > 0) ? repeat : 1;
+			index = index + 1;
+
+		} else if(strcmp(argv[index], "--max-spheres") == 0) {
+			// Leave out the larger sphere counts, 0 keeps them all
+			max_spheres = parse_count(argc, argv, index, "--max-spheres");
+			index = index + 1;
+
+		} else if(strcmp(argv[index], "--kernels") == 0) {
+			// Time the intersection kernels on pregenerated rays instead of the pipeline
+			kernels = 1;
+
+		} else if(strcmp(argv[index], "--warmup") == 0) {
+			warmup = parse_count(argc, argv, index, "--warmup");
+			index = index + 1;
+
+		} else if(strcmp(argv[index], "--quick") == 0) {
+			// Small matrix, checks the pipeline runs rather than measuring it
+			quick = 1;
+
+		} else if((strcmp(argv[index], "--dir") == 0) && (index + 1 < argc)) {
+			// Directory the generated scene and rendered image are written to
+			directory = argv[index + 1];
+			index = index + 1;
+
+		} else {
+			fprintf(stderr, "Error, incorrect usage!\nCorrect usage pattern is: raycast-bench [--threads n] [--simd level] [--no-bvh] [--seed n] [--repeat n] [--max-spheres n] [--quick] [--dir path].\n");
+			fprintf(stderr, "To time the intersection kernels: raycast-bench --kernels [--simd level] [--seed n] [--warmup n] [--repeat n].\n");
+			exit(-1);
+
+		}
+
+	}
+
+	// Install the widest supported intersection kernels before any case is forked
+	simd_level = simd_select(simd_level);
+
+	if(kernels) {
+		microbench_run(seed, warmup, (repeat > 0) ? repeat : 20, simd_level);
+		return(0);
+
+	}
+
+	repeat = (repeat > 0) ? repeat : 3;
+	resolutions = quick ? quick_resolutions : bench_resolutions;
+	num_resolutions = quick ? sizeof(quick_resolutions) / sizeof(quick_resolutions[0]) : sizeof(bench_resolutions) / sizeof(bench_resolutions[0]);
+	spheres = quick ? quick_spheres : bench_spheres;
+	num_spheres = quick ? sizeof(quick_spheres) / sizeof(quick_spheres[0]) : sizeof(bench_spheres) / sizeof(bench_spheres[0]);
+
+	snprintf(scene_file, sizeof(scene_file), "%s/bench.json", directory);
+	snprintf(image_file, sizeof(image_file), "%s/bench.ppm", directory);
+
+	printf("{\n  \"seed\": %u,\n  \"threads\": %d,\n  \"simd\": \"%s\",\n  \"bvh\": %s,\n  \"repeat\": %d,\n  \"planes\": %d,\n  \"cases\": [",
+		seed, num_threads, simd_level_name(simd_level), use_bvh ? "true" : "false", repeat, BENCH_PLANES);
+
+	first = 1;
+
+	for(layout = LAYOUT_UNIFORM; layout <= LAYOUT_STACKED; layout++) {
+		for(sphere = 0; sphere < num_spheres; sphere++) {
+			if((max_spheres > 0) && (spheres[sphere] > max_spheres)) {
+				continue;
+
+			}
+
+			bench_generate(scene_file, (BenchLayout)layout, spheres[sphere], BENCH_PLANES, seed);
+
+			for(resolution = 0; resolution < num_resolutions; resolution++) {
+				fprintf(stderr, "%s %d spheres %dx%d\n", bench_layout_name((BenchLayout)layout), spheres[sphere],
+					resolutions[resolution][0], resolutions[resolution][1]);
+
+				bench_fork(scene_file, image_file, resolutions[resolution][0], resolutions[resolution][1], use_bvh, num_threads, repeat, &result);
+				rays = (double)resolutions[resolution][0] * resolutions[resolution][1];
+
+				printf("%s\n    {\"layout\": \"%s\", \"spheres\": %d, \"width\": %d, \"height\": %d, ", first ? "" : ",",
+					bench_layout_name((BenchLayout)layout), spheres[sphere], resolutions[resolution][0], resolutions[resolution][1]);
+
+				if(result.failed) {
+					printf("\"failed\": true}");
+
+				} else {
+					printf("\"parse_ms\": %.3f, \"build_ms\": %.3f, \"render_ms\": %.3f, \"write_ms\": %.3f, \"total_ms\": %.3f, ",
+						result.parse_ms, result.build_ms, result.render_ms, result.write_ms, result.total_ms);
+					printf("\"rays_per_sec\": %.0f, \"peak_rss_kb\": %ld}", (result.render_ms > 0) ? rays * 1000.0 / result.render_ms : 0.0, result.peak_rss);
+
+				}
+
+				fflush(stdout);
+				first = 0;
+
+			}
+
+		}
+
+	}
+
+	printf("\n  ]\n}\n");
+
+	remove(scene_file);
+	remove(image_file);
+
+	return(0);
+
+}
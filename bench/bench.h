@@ -0,0 +1,56 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: bench.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef bench_h
+#define bench_h
+
+// Planes in every generated scene, a floor and a back wall, planes are never in the hierarchy
+#define BENCH_PLANES 2
+
+// Depth range of the generated scenes in front of the camera
+#define BENCH_NEAR 4.0
+#define BENCH_FAR 44.0
+
+// Clusters in a clustered scene
+#define BENCH_CLUSTERS 8
+
+/**
+ * BenchLayout
+ *
+ * @description how a generated scene places its spheres. Uniform spreads them through the view,
+ * clustered packs them into a few tight groups, and stacked lines them up in columns along the
+ * view direction so every pixel looks through many spheres.
+ */
+typedef enum BenchLayout {
+	LAYOUT_UNIFORM = 0,
+	LAYOUT_CLUSTERED,
+	LAYOUT_STACKED
+
+} BenchLayout;
+
+
+/**
+ * BenchResult
+ *
+ * @description timings of one benchmark case in milliseconds, the fastest of the repetitions for
+ * each phase. Parse covers reading the json scene and building the render scene, build covers the
+ * bounding volume hierarchy, render covers casting one ray per pixel, and write covers the ppm6
+ * image. peak_rss is the case's peak resident set size in kilobytes.
+ */
+typedef struct BenchResult {
+	double parse_ms, build_ms, render_ms, write_ms, total_ms;
+	long peak_rss;
+	int failed;
+
+} BenchResult;
+
+// function declarations
+const char *bench_layout_name(BenchLayout layout);
+void bench_generate(const char *filename, BenchLayout layout, int num_spheres, int num_planes, unsigned int seed);
+
+#endif
@@ -0,0 +1,477 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: binscene.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\scene\scene.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "binscene.h"
+
+/**
+ * host_little_endian
+ *
+ * @returns 1 when the processor stores integers little-endian, 0 otherwise
+ * @description binary scene files are little-endian and are read and written without byte
+ * swapping, other hosts are refused
+ */
+static int host_little_endian(void) {
+	uint16_t value = 1;
+
+	return (*(unsigned char *)&value == 1);
+
+}
+
+
+/**
+ * section_align
+ *
+ * @param offset - file offset
+ * @returns offset rounded up to the next section boundary
+ * @description sections start on BINSCENE_ALIGN byte boundaries so mapped columns are aligned
+ * for the packet kernels
+ */
+static uint64_t section_align(uint64_t offset) {
+	return (offset + BINSCENE_ALIGN - 1) & ~(uint64_t)(BINSCENE_ALIGN - 1);
+
+}
+
+
+/**
+ * write_section
+ *
+ * @param fpointer - binary scene file
+ * @param position - current file offset, advanced past the section
+ * @param data - section contents
+ * @param size - section size in bytes
+ * @returns void
+ * @description pads the file to the next section boundary and writes one section
+ */
+static void write_section(FILE *fpointer, uint64_t *position, const void *data, size_t size) {
+	static const char padding[BINSCENE_ALIGN];
+	uint64_t start = section_align(*position);
+
+	if(((start > *position) && (fwrite(padding, 1, start - *position, fpointer) != start - *position)) ||
+		((size > 0) && (fwrite(data, 1, size, fpointer) != size))) {
+		fprintf(stderr, "Error, could not write binary scene file.\n");
+		fclose(fpointer);
+		exit(-1);
+
+	}
+
+	*position = start + size;
+
+}
+
+
+/**
+ * binscene_detect
+ *
+ * @param fpointer - file opened for reading, left positioned at its start
+ * @returns 1 when the file starts with the binary scene magic, 0 otherwise
+ * @description tells binary scene files apart from json scene files
+ */
+int binscene_detect(FILE *fpointer) {
+	char magic[4];
+	size_t count;
+
+	count = fread(magic, 1, sizeof(magic), fpointer);
+	rewind(fpointer);
+
+	return ((count == sizeof(magic)) && (memcmp(magic, BINSCENE_MAGIC, sizeof(magic)) == 0));
+
+}
+
+
+/**
+ * binscene_write
+ *
+ * @param filename - path of the binary scene file to create
+ * @param scene - render scene to store, including its bounding volume hierarchy when it has one
+ * @param num_objects - number of objects in the json scene the render scene was built from
+ * @returns void
+ * @description writes a render scene as a binary scene file that binscene_load maps back in
+ * without parsing
+ */
+void binscene_write(const char *filename, RenderScene *scene, int num_objects) {
+	BinSceneHeader header;
+	FILE *fpointer;
+	uint64_t position;
+	const void *sphere_columns[BINSCENE_SPHERE_COLUMNS];
+	const void *plane_columns[BINSCENE_PLANE_COLUMNS];
+	size_t size;
+	int index;
+
+	if(host_little_endian() == 0) {
+		fprintf(stderr, "Error, binary scene files require a little-endian processor.\n");
+		exit(-1);
+
+	}
+
+	sphere_columns[0] = scene->sphere_x;
+	sphere_columns[1] = scene->sphere_y;
+	sphere_columns[2] = scene->sphere_z;
+	sphere_columns[3] = scene->sphere_radius;
+	sphere_columns[4] = scene->sphere_red;
+	sphere_columns[5] = scene->sphere_green;
+	sphere_columns[6] = scene->sphere_blue;
+	sphere_columns[7] = scene->sphere_order;
+
+	plane_columns[0] = scene->plane_x;
+	plane_columns[1] = scene->plane_y;
+	plane_columns[2] = scene->plane_z;
+	plane_columns[3] = scene->plane_nx;
+	plane_columns[4] = scene->plane_ny;
+	plane_columns[5] = scene->plane_nz;
+	plane_columns[6] = scene->plane_red;
+	plane_columns[7] = scene->plane_green;
+	plane_columns[8] = scene->plane_blue;
+	plane_columns[9] = scene->plane_order;
+
+	// Lay out the sections behind the header
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, BINSCENE_MAGIC, sizeof(header.magic));
+	header.version = BINSCENE_VERSION;
+	header.header_size = sizeof(BinSceneHeader);
+	header.num_objects = (num_objects > 0) ? num_objects : 0;
+	header.has_camera = scene->has_camera;
+	header.camera_width = scene->camera_width;
+	header.camera_height = scene->camera_height;
+	header.num_spheres = scene->num_spheres;
+	header.num_planes = scene->num_planes;
+	header.num_nodes = (scene->bvh != NULL) ? scene->bvh->num_nodes : 0;
+
+	position = sizeof(BinSceneHeader);
+
+	for(index = 0; index < BINSCENE_SPHERE_COLUMNS; index++) {
+		size = (index < BINSCENE_SPHERE_COLUMNS - 1) ? sizeof(double) : sizeof(int32_t);
+		header.sphere_offset[index] = section_align(position);
+		position = header.sphere_offset[index] + size * header.num_spheres;
+
+	}
+
+	for(index = 0; index < BINSCENE_PLANE_COLUMNS; index++) {
+		size = (index < BINSCENE_PLANE_COLUMNS - 1) ? sizeof(double) : sizeof(int32_t);
+		header.plane_offset[index] = section_align(position);
+		position = header.plane_offset[index] + size * header.num_planes;
+
+	}
+
+	header.node_offset = section_align(position);
+	header.file_size = header.node_offset + sizeof(BvhNode) * header.num_nodes;
+
+	fpointer = fopen(filename, "wb");
+
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, could not open file.\n");
+		exit(-1);
+
+	}
+
+	// Write the header and the sections in layout order
+	position = 0;
+	write_section(fpointer, &position, &header, sizeof(header));
+
+	for(index = 0; index < BINSCENE_SPHERE_COLUMNS; index++) {
+		size = (index < BINSCENE_SPHERE_COLUMNS - 1) ? sizeof(double) : sizeof(int32_t);
+		write_section(fpointer, &position, sphere_columns[index], size * header.num_spheres);
+
+	}
+
+	for(index = 0; index < BINSCENE_PLANE_COLUMNS; index++) {
+		size = (index < BINSCENE_PLANE_COLUMNS - 1) ? sizeof(double) : sizeof(int32_t);
+		write_section(fpointer, &position, plane_columns[index], size * header.num_planes);
+
+	}
+
+	write_section(fpointer, &position, (header.num_nodes > 0) ? scene->bvh->nodes : NULL, sizeof(BvhNode) * header.num_nodes);
+
+	if(fclose(fpointer) != 0) {
+		fprintf(stderr, "Error, could not write binary scene file.\n");
+		exit(-1);
+
+	}
+
+}
+
+
+/**
+ * map_column
+ *
+ * @param header - validated header
+ * @param mapping - start of the mapped file
+ * @param offset - section offset
+ * @param count - number of elements
+ * @param size - size of one element
+ * @returns pointer to the column inside the mapping
+ * @description checks that a section lies inside the file. Empty columns point at the header so
+ * every column pointer stays inside the mapping.
+ */
+static void *map_column(BinSceneHeader *header, char *mapping, uint64_t offset, uint32_t count, size_t size) {
+	if((offset % BINSCENE_ALIGN != 0) || (offset < sizeof(BinSceneHeader)) || (offset > header->file_size) ||
+		((uint64_t)count * size > header->file_size - offset)) {
+		fprintf(stderr, "Error, corrupt binary scene file.\n");
+		exit(-1);
+
+	}
+
+	return (count > 0) ? mapping + offset : mapping;
+
+}
+
+
+/**
+ * validate_nodes
+ *
+ * @param nodes - mapped hierarchy nodes
+ * @param num_nodes - number of nodes
+ * @param num_spheres - number of spheres
+ * @returns void
+ * @description makes sure a stored hierarchy can be traversed safely. Children always follow
+ * their parent and leaves stay inside the sphere columns. Every node is the child of at most one
+ * parent, so the nodes form a tree, and no path is deeper than the traversal stack allows. Since
+ * a child follows its one parent its depth is known before it is checked.
+ */
+static void validate_nodes(BvhNode *nodes, uint32_t num_nodes, uint32_t num_spheres) {
+	unsigned char *depth, *referenced;
+	uint32_t node;
+	int64_t child;
+	int valid = 1;
+
+	depth = calloc(num_nodes, 1);
+	referenced = calloc(num_nodes, 1);
+
+	if((depth == NULL) || (referenced == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(node = 0; (node < num_nodes) && valid; node++) {
+		if(nodes[node].count == 0) {
+			child = nodes[node].first;
+			valid = (child > (int64_t)node) && ((uint64_t)child + 1 < num_nodes) && (depth[node] < BVH_MAX_DEPTH) &&
+				(referenced[child] == 0) && (referenced[child + 1] == 0);
+
+			if(valid) {
+				referenced[child] = 1;
+				referenced[child + 1] = 1;
+				depth[child] = depth[node] + 1;
+				depth[child + 1] = depth[node] + 1;
+
+			}
+
+		} else {
+			valid = (nodes[node].count > 0) && (nodes[node].first >= 0) &&
+				((uint64_t)nodes[node].first + nodes[node].count <= num_spheres);
+
+		}
+
+	}
+
+	free(referenced);
+	free(depth);
+
+	if(valid == 0) {
+		fprintf(stderr, "Error, corrupt binary scene file.\n");
+		exit(-1);
+
+	}
+
+}
+
+
+/**
+ * validate_order
+ *
+ * @param sphere_order - mapped sphere order column
+ * @param num_spheres - number of spheres
+ * @param plane_order - mapped plane order column
+ * @param num_planes - number of planes
+ * @param num_objects - number of objects of the json scene the file was made from
+ * @returns void
+ * @description makes sure the order columns can be used as scene indices. Every sphere and plane
+ * is one object of the scene, so each order value lies inside the scene and no two primitives
+ * share one.
+ */
+static void validate_order(int *sphere_order, uint32_t num_spheres, int *plane_order, uint32_t num_planes, uint32_t num_objects) {
+	unsigned char *seen;
+	int *order;
+	uint32_t index, count;
+	int column, valid = 1;
+
+	seen = calloc((num_objects > 0) ? num_objects : 1, 1);
+
+	if(seen == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(column = 0; (column < 2) && valid; column++) {
+		order = (column == 0) ? sphere_order : plane_order;
+		count = (column == 0) ? num_spheres : num_planes;
+
+		for(index = 0; (index < count) && valid; index++) {
+			valid = (order[index] >= 0) && ((uint32_t)order[index] < num_objects) && (seen[order[index]] == 0);
+
+			if(valid) {
+				seen[order[index]] = 1;
+
+			}
+
+		}
+
+	}
+
+	free(seen);
+
+	if(valid == 0) {
+		fprintf(stderr, "Error, corrupt binary scene file.\n");
+		exit(-1);
+
+	}
+
+}
+
+
+/**
+ * binscene_load
+ *
+ * @param filename - path of the binary scene file
+ * @param num_objects - receives the number of objects of the json scene the file was made from
+ * @returns a RenderScene whose columns and hierarchy live in the file's memory mapping
+ * @description maps a binary scene file written by binscene_write and points a render scene at
+ * its sections, nothing is parsed or copied. The mapping is private and writable so a hierarchy
+ * can still be built over a file that has none. scene_free releases the mapping.
+ */
+RenderScene *binscene_load(const char *filename, int *num_objects) {
+	BinSceneHeader *header;
+	RenderScene *scene;
+	struct stat status;
+	char *mapping;
+	int descriptor;
+
+	if(host_little_endian() == 0) {
+		fprintf(stderr, "Error, binary scene files require a little-endian processor.\n");
+		exit(-1);
+
+	}
+
+	descriptor = open(filename, O_RDONLY);
+
+	if((descriptor < 0) || (fstat(descriptor, &status) != 0)) {
+		fprintf(stderr, "Error, could not open file.\n");
+		exit(-1);
+
+	}
+
+	if((size_t)status.st_size < sizeof(BinSceneHeader)) {
+		fprintf(stderr, "Error, corrupt binary scene file.\n");
+		close(descriptor);
+		exit(-1);
+
+	}
+
+	mapping = mmap(NULL, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+	close(descriptor);
+
+	if(mapping == MAP_FAILED) {
+		fprintf(stderr, "Error, could not map file.\n");
+		exit(-1);
+
+	}
+
+	header = (BinSceneHeader *)mapping;
+
+	if((memcmp(header->magic, BINSCENE_MAGIC, sizeof(header->magic)) != 0) || (header->version != BINSCENE_VERSION) ||
+		(header->header_size != sizeof(BinSceneHeader))) {
+		fprintf(stderr, "Error, unsupported binary scene file version.\n");
+		exit(-1);
+
+	}
+
+	if((header->file_size != (uint64_t)status.st_size) || (header->num_spheres > INT32_MAX) ||
+		(header->num_planes > INT32_MAX) || (header->num_objects > INT32_MAX) ||
+		((uint64_t)header->num_spheres + header->num_planes > header->num_objects) ||
+		(header->num_nodes > 2 * (uint64_t)header->num_spheres)) {
+		fprintf(stderr, "Error, corrupt binary scene file.\n");
+		exit(-1);
+
+	}
+
+	scene = calloc(1, sizeof(RenderScene));
+
+	if(scene == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	scene->mapping = mapping;
+	scene->mapping_size = (size_t)status.st_size;
+	scene->has_camera = header->has_camera;
+	scene->camera_width = header->camera_width;
+	scene->camera_height = header->camera_height;
+
+	scene->num_spheres = header->num_spheres;
+	scene->max_spheres = header->num_spheres;
+	scene->sphere_x = map_column(header, mapping, header->sphere_offset[0], header->num_spheres, sizeof(double));
+	scene->sphere_y = map_column(header, mapping, header->sphere_offset[1], header->num_spheres, sizeof(double));
+	scene->sphere_z = map_column(header, mapping, header->sphere_offset[2], header->num_spheres, sizeof(double));
+	scene->sphere_radius = map_column(header, mapping, header->sphere_offset[3], header->num_spheres, sizeof(double));
+	scene->sphere_red = map_column(header, mapping, header->sphere_offset[4], header->num_spheres, sizeof(double));
+	scene->sphere_green = map_column(header, mapping, header->sphere_offset[5], header->num_spheres, sizeof(double));
+	scene->sphere_blue = map_column(header, mapping, header->sphere_offset[6], header->num_spheres, sizeof(double));
+	scene->sphere_order = map_column(header, mapping, header->sphere_offset[7], header->num_spheres, sizeof(int32_t));
+
+	scene->num_planes = header->num_planes;
+	scene->max_planes = header->num_planes;
+	scene->plane_x = map_column(header, mapping, header->plane_offset[0], header->num_planes, sizeof(double));
+	scene->plane_y = map_column(header, mapping, header->plane_offset[1], header->num_planes, sizeof(double));
+	scene->plane_z = map_column(header, mapping, header->plane_offset[2], header->num_planes, sizeof(double));
+	scene->plane_nx = map_column(header, mapping, header->plane_offset[3], header->num_planes, sizeof(double));
+	scene->plane_ny = map_column(header, mapping, header->plane_offset[4], header->num_planes, sizeof(double));
+	scene->plane_nz = map_column(header, mapping, header->plane_offset[5], header->num_planes, sizeof(double));
+	scene->plane_red = map_column(header, mapping, header->plane_offset[6], header->num_planes, sizeof(double));
+	scene->plane_green = map_column(header, mapping, header->plane_offset[7], header->num_planes, sizeof(double));
+	scene->plane_blue = map_column(header, mapping, header->plane_offset[8], header->num_planes, sizeof(double));
+	scene->plane_order = map_column(header, mapping, header->plane_offset[9], header->num_planes, sizeof(int32_t));
+	validate_order(scene->sphere_order, header->num_spheres, scene->plane_order, header->num_planes, header->num_objects);
+
+	if(header->num_nodes > 0) {
+		scene->bvh = malloc(sizeof(Bvh));
+
+		if(scene->bvh == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		scene->bvh->nodes = map_column(header, mapping, header->node_offset, header->num_nodes, sizeof(BvhNode));
+		scene->bvh->num_nodes = header->num_nodes;
+		validate_nodes(scene->bvh->nodes, header->num_nodes, header->num_spheres);
+
+	}
+
+	// Every section is read by the renderer, start paging the file in now
+	madvise(mapping, (size_t)status.st_size, MADV_WILLNEED);
+
+	*num_objects = header->num_objects;
+
+	return scene;
+
+}
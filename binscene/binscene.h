@@ -0,0 +1,60 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: binscene.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef binscene_h
+#define binscene_h
+
+#include <stdint.h>
+
+// First bytes of every binary scene file
+#define BINSCENE_MAGIC "RSCN"
+
+// Bumped whenever the layout below changes, older files are rejected
+#define BINSCENE_VERSION 3
+
+// Alignment of every section from the start of the file
+#define BINSCENE_ALIGN 64
+
+// Number of sphere and plane columns, in the order they are stored
+#define BINSCENE_SPHERE_COLUMNS 8
+#define BINSCENE_PLANE_COLUMNS 10
+
+/**
+ * BinSceneHeader
+ *
+ * @description header at the start of a binary scene file. All values are little-endian. The
+ * sphere columns are x, y, z, radius, red, green, blue as doubles followed by order as 32 bit
+ * integers, the plane columns are x, y, z, nx, ny, nz, red, green, blue as doubles followed by
+ * order. Offsets are counted from the start of the file. A file stores the render scene, plane
+ * normals are already normalized, and when num_nodes is not 0 it also stores the bounding volume
+ * hierarchy over the spheres, the sphere columns are then in leaf order.
+ */
+typedef struct BinSceneHeader {
+	char magic[4];
+	uint32_t version;
+	uint32_t header_size;
+	uint32_t num_objects;
+	uint32_t has_camera;
+	uint32_t num_spheres;
+	uint32_t num_planes;
+	uint32_t num_nodes;
+	double camera_width;
+	double camera_height;
+	uint64_t sphere_offset[BINSCENE_SPHERE_COLUMNS];
+	uint64_t plane_offset[BINSCENE_PLANE_COLUMNS];
+	uint64_t node_offset;
+	uint64_t file_size;
+
+} BinSceneHeader;
+
+// function declarations
+int binscene_detect(FILE *fpointer);
+void binscene_write(const char *filename, RenderScene *scene, int num_objects);
+RenderScene *binscene_load(const char *filename, int *num_objects);
+
+#endif
@@ -0,0 +1,618 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: bvh.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\scene\scene.h"
+#include "..\threadpool\threadpool.h"
+#include "bvh.h"
+
+// Number of centroid bins evaluated per split
+#define BVH_BINS 16
+
+// Leaves at or below this size are never split, leaves are never larger than BVH_MAX_LEAF
+#define BVH_MIN_LEAF 4
+#define BVH_MAX_LEAF 16
+
+// Subtrees larger than this are built as separate thread pool tasks
+#define BVH_TASK_SIZE 4096
+
+/**
+ * Bounds
+ *
+ * @description double precision axis aligned box used while building
+ */
+typedef struct Bounds {
+	double min[3];
+	double max[3];
+
+} Bounds;
+
+
+/**
+ * BvhBuilder
+ *
+ * @description state shared by every build task, the sphere index permutation and the node array
+ */
+typedef struct BvhBuilder {
+	RenderScene *scene;
+	ThreadPool *pool;
+	int *indices;
+	BvhNode *nodes;
+	int num_nodes;
+
+} BvhBuilder;
+
+
+/**
+ * BuildTask
+ *
+ * @description a subtree handed to the thread pool
+ */
+typedef struct BuildTask {
+	BvhBuilder *builder;
+	int node, first, count, depth;
+
+} BuildTask;
+
+static void build_node(BvhBuilder *builder, int node, int first, int count, int depth);
+
+
+/**
+ * bounds_empty
+ *
+ * @param bounds - box to reset
+ * @returns void
+ * @description resets a box so that growing it by any point yields that point
+ */
+static inline void bounds_empty(Bounds *bounds) {
+	int axis;
+
+	for(axis = 0; axis < 3; axis++) {
+		bounds->min[axis] = INFINITY;
+		bounds->max[axis] = -INFINITY;
+
+	}
+
+}
+
+
+/**
+ * bounds_grow
+ *
+ * @param bounds - box to grow
+ * @param min - lower corner to include
+ * @param max - upper corner to include
+ * @returns void
+ * @description grows a box to contain another box
+ */
+static inline void bounds_grow(Bounds *bounds, const double *min, const double *max) {
+	int axis;
+
+	for(axis = 0; axis < 3; axis++) {
+		if(min[axis] < bounds->min[axis]) {
+			bounds->min[axis] = min[axis];
+
+		}
+
+		if(max[axis] > bounds->max[axis]) {
+			bounds->max[axis] = max[axis];
+
+		}
+
+	}
+
+}
+
+
+/**
+ * bounds_area
+ *
+ * @param bounds - box
+ * @returns half the surface area of the box, 0 for an empty box
+ * @description surface area heuristic weight of a box
+ */
+static inline double bounds_area(const Bounds *bounds) {
+	double dx = bounds->max[0] - bounds->min[0];
+	double dy = bounds->max[1] - bounds->min[1];
+	double dz = bounds->max[2] - bounds->min[2];
+
+	if((dx < 0) || (dy < 0) || (dz < 0)) {
+		return(0);
+
+	}
+
+	return (dx * dy) + (dy * dz) + (dz * dx);
+
+}
+
+
+/**
+ * sphere_center
+ *
+ * @param scene - render scene
+ * @param sphere - sphere index
+ * @param center - receives the center of the sphere
+ * @returns the radius of the sphere
+ * @description reads a sphere from the double precision columns, or from the single precision
+ * geometry of a compact scene
+ */
+static inline double sphere_center(RenderScene *scene, int sphere, double *center) {
+	if(scene->compact) {
+		center[0] = scene->single->sphere_x[sphere];
+		center[1] = scene->single->sphere_y[sphere];
+		center[2] = scene->single->sphere_z[sphere];
+
+		return scene->single->sphere_radius[sphere];
+
+	}
+
+	center[0] = scene->sphere_x[sphere];
+	center[1] = scene->sphere_y[sphere];
+	center[2] = scene->sphere_z[sphere];
+
+	return scene->sphere_radius[sphere];
+
+}
+
+
+/**
+ * sphere_bounds
+ *
+ * @param scene - render scene
+ * @param sphere - sphere index
+ * @param min - receives the lower corner
+ * @param max - receives the upper corner
+ * @returns void
+ * @description box around a sphere padded by a small relative margin so rounding in the sphere
+ * intersection can never place a hit outside of its node
+ */
+static inline void sphere_bounds(RenderScene *scene, int sphere, double *min, double *max) {
+	double center[3], radius, pad;
+	int axis;
+
+	radius = fabs(sphere_center(scene, sphere, center));
+
+	for(axis = 0; axis < 3; axis++) {
+		pad = (fabs(center[axis]) + radius) * 1e-9;
+		min[axis] = center[axis] - radius - pad;
+		max[axis] = center[axis] + radius + pad;
+
+	}
+
+}
+
+
+/**
+ * store_bounds
+ *
+ * @param node - node to write
+ * @param bounds - double precision bounds
+ * @returns void
+ * @description converts bounds to single precision rounding the lower corner down and the
+ * upper corner up
+ */
+static void store_bounds(BvhNode *node, const Bounds *bounds) {
+	int axis;
+
+	for(axis = 0; axis < 3; axis++) {
+		node->min[axis] = (float)bounds->min[axis];
+		node->max[axis] = (float)bounds->max[axis];
+
+		if((double)node->min[axis] > bounds->min[axis]) {
+			node->min[axis] = nextafterf(node->min[axis], -INFINITY);
+
+		}
+
+		if((double)node->max[axis] < bounds->max[axis]) {
+			node->max[axis] = nextafterf(node->max[axis], INFINITY);
+
+		}
+
+	}
+
+}
+
+
+/**
+ * build_task
+ *
+ * @param arg - BuildTask
+ * @returns void
+ * @description thread pool entry point for a subtree
+ */
+static void build_task(void *arg) {
+	BuildTask task = *(BuildTask *)arg;
+
+	free(arg);
+	build_node(task.builder, task.node, task.first, task.count, task.depth);
+
+}
+
+
+/**
+ * build_node
+ *
+ * @param builder - shared build state
+ * @param node - index of the node to fill
+ * @param first - first entry of the node's range in the index permutation
+ * @param count - number of spheres in the range
+ * @param depth - depth of the node
+ * @returns void
+ * @description binned surface area heuristic build. Sphere centers are binned along the widest
+ * centroid axis, the cheapest of the BVH_BINS - 1 bin boundaries is chosen and the range is
+ * partitioned in place. Large right subtrees become thread pool tasks while the left subtree
+ * continues on the calling thread.
+ */
+static void build_node(BvhBuilder *builder, int node, int first, int count, int depth) {
+	RenderScene *scene = builder->scene;
+	int *indices = builder->indices;
+	Bounds bounds, centroids, bin_bounds[BVH_BINS], left_bounds[BVH_BINS];
+	int bin_count[BVH_BINS], left_count[BVH_BINS];
+	double min[3], max[3], center[3], extent, scale, cost, best_cost, right_area;
+	int index, axis, bin, split, best_split, right_count, children, swap, middle;
+	Bounds right_bounds;
+	BuildTask *task;
+
+	bounds_empty(&bounds);
+	bounds_empty(&centroids);
+
+	for(index = first; index < first + count; index++) {
+		sphere_bounds(scene, indices[index], min, max);
+		bounds_grow(&bounds, min, max);
+
+		sphere_center(scene, indices[index], center);
+		bounds_grow(&centroids, center, center);
+
+	}
+
+	store_bounds(&builder->nodes[node], &bounds);
+
+	if(count <= BVH_MIN_LEAF) {
+		builder->nodes[node].first = first;
+		builder->nodes[node].count = count;
+		return;
+
+	}
+
+	// Split along the axis with the widest spread of centers
+	axis = 0;
+
+	for(index = 1; index < 3; index++) {
+		if((centroids.max[index] - centroids.min[index]) > (centroids.max[axis] - centroids.min[axis])) {
+			axis = index;
+
+		}
+
+	}
+
+	extent = centroids.max[axis] - centroids.min[axis];
+	middle = -1;
+	best_split = -1;
+
+	if((extent > 0) && (depth < BVH_MAX_DEPTH - 32)) {
+		scale = BVH_BINS / extent;
+
+		for(bin = 0; bin < BVH_BINS; bin++) {
+			bounds_empty(&bin_bounds[bin]);
+			bin_count[bin] = 0;
+
+		}
+
+		for(index = first; index < first + count; index++) {
+			sphere_center(scene, indices[index], center);
+			bin = (int)((center[axis] - centroids.min[axis]) * scale);
+			bin = (bin < BVH_BINS) ? bin : BVH_BINS - 1;
+
+			sphere_bounds(scene, indices[index], min, max);
+			bounds_grow(&bin_bounds[bin], min, max);
+			bin_count[bin] = bin_count[bin] + 1;
+
+		}
+
+		// Sweep from the left accumulating bounds and counts
+		bounds_empty(&left_bounds[0]);
+		left_count[0] = 0;
+
+		for(bin = 1; bin < BVH_BINS; bin++) {
+			left_bounds[bin] = left_bounds[bin - 1];
+			bounds_grow(&left_bounds[bin], bin_bounds[bin - 1].min, bin_bounds[bin - 1].max);
+			left_count[bin] = left_count[bin - 1] + bin_count[bin - 1];
+
+		}
+
+		// Sweep from the right evaluating the cost of splitting before each bin
+		bounds_empty(&right_bounds);
+		right_count = 0;
+		best_cost = count * bounds_area(&bounds);
+
+		for(split = BVH_BINS - 1; split > 0; split--) {
+			bounds_grow(&right_bounds, bin_bounds[split].min, bin_bounds[split].max);
+			right_count = right_count + bin_count[split];
+			right_area = bounds_area(&right_bounds);
+			cost = (left_count[split] * bounds_area(&left_bounds[split])) + (right_count * right_area);
+
+			if((left_count[split] > 0) && (right_count > 0) && (cost < best_cost)) {
+				best_cost = cost;
+				best_split = split;
+
+			}
+
+		}
+
+		if((best_split < 0) && (count <= BVH_MAX_LEAF)) {
+			// Splitting costs more than intersecting every sphere in one leaf
+			builder->nodes[node].first = first;
+			builder->nodes[node].count = count;
+			return;
+
+		}
+
+		if(best_split >= 0) {
+			// Partition the range, spheres left of the split bin first
+			middle = first;
+
+			for(index = first; index < first + count; index++) {
+				sphere_center(scene, indices[index], center);
+				bin = (int)((center[axis] - centroids.min[axis]) * scale);
+				bin = (bin < BVH_BINS) ? bin : BVH_BINS - 1;
+
+				if(bin < best_split) {
+					swap = indices[index];
+					indices[index] = indices[middle];
+					indices[middle] = swap;
+					middle = middle + 1;
+
+				}
+
+			}
+
+		}
+
+	}
+
+	if(middle < 0) {
+		// Coincident centers, too deep, or no useful split, halve the range
+		if(count <= BVH_MAX_LEAF) {
+			builder->nodes[node].first = first;
+			builder->nodes[node].count = count;
+			return;
+
+		}
+
+		middle = first + count / 2;
+
+	}
+
+	children = __atomic_fetch_add(&builder->num_nodes, 2, __ATOMIC_RELAXED);
+	builder->nodes[node].first = children;
+	builder->nodes[node].count = 0;
+
+	if((builder->pool != NULL) && (first + count - middle > BVH_TASK_SIZE)) {
+		task = malloc(sizeof(BuildTask));
+
+		if(task == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		task->builder = builder;
+		task->node = children + 1;
+		task->first = middle;
+		task->count = first + count - middle;
+		task->depth = depth + 1;
+		threadpool_submit(builder->pool, build_task, task);
+
+	} else {
+		build_node(builder, children + 1, middle, first + count - middle, depth + 1);
+
+	}
+
+	build_node(builder, children, first, middle - first, depth + 1);
+
+}
+
+
+/**
+ * permute_column
+ *
+ * @param scene - render scene the column belongs to
+ * @param column - structure of arrays column to reorder
+ * @param indices - new order, entry i names the old position of element i
+ * @param count - number of elements
+ * @param size - size of one element
+ * @returns the reordered column, the old column is released
+ * @description moves a scene column into leaf order
+ */
+static void *permute_column(RenderScene *scene, void *column, const int *indices, int count, size_t size) {
+	char *permuted;
+	int index;
+
+	permuted = malloc(size * (count > 0 ? count : 1));
+
+	if(permuted == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(index = 0; index < count; index++) {
+		memcpy(permuted + size * index, (char *)column + size * indices[index], size);
+
+	}
+
+	scene_column_free(scene, column);
+
+	return permuted;
+
+}
+
+
+/**
+ * bvh_build
+ *
+ * @param scene - render scene whose spheres are organized, the sphere columns are reordered
+ * so that every leaf covers a contiguous range of them. The scene should be prepared first,
+ * scene_prepare rejects the non finite spheres that would break the binning.
+ * @param pool - thread pool used for large subtrees, NULL builds on the calling thread
+ * @returns a newly allocated Bvh, NULL when the scene has too few spheres to benefit
+ * @description builds a bounding volume hierarchy over the scene's spheres
+ */
+Bvh *bvh_build(RenderScene *scene, ThreadPool *pool) {
+	BvhBuilder builder;
+	Bvh *bvh;
+	int index;
+
+	if(scene->num_spheres < BVH_MIN_SPHERES) {
+		return NULL;
+
+	}
+
+	builder.scene = scene;
+	builder.pool = pool;
+	builder.num_nodes = 1;
+	builder.indices = malloc(sizeof(int) * scene->num_spheres);
+	builder.nodes = malloc(sizeof(BvhNode) * 2 * scene->num_spheres);
+
+	if((builder.indices == NULL) || (builder.nodes == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(index = 0; index < scene->num_spheres; index++) {
+		builder.indices[index] = index;
+
+	}
+
+	build_node(&builder, 0, 0, scene->num_spheres, 0);
+
+	if(pool != NULL) {
+		threadpool_wait(pool);
+
+	}
+
+	// Store the spheres in leaf order so each leaf is one packet kernel call
+	if(scene->compact) {
+		scene->single->sphere_x = permute_column(scene, scene->single->sphere_x, builder.indices, scene->num_spheres, sizeof(float));
+		scene->single->sphere_y = permute_column(scene, scene->single->sphere_y, builder.indices, scene->num_spheres, sizeof(float));
+		scene->single->sphere_z = permute_column(scene, scene->single->sphere_z, builder.indices, scene->num_spheres, sizeof(float));
+		scene->single->sphere_radius = permute_column(scene, scene->single->sphere_radius, builder.indices, scene->num_spheres, sizeof(float));
+		scene->sphere_color = permute_column(scene, scene->sphere_color, builder.indices, scene->num_spheres, sizeof(unsigned int));
+		scene->sphere_order = permute_column(scene, scene->sphere_order, builder.indices, scene->num_spheres, sizeof(int));
+
+		if(scene->prepared) {
+			scene->single->sphere_c = permute_column(scene, scene->single->sphere_c, builder.indices, scene->num_spheres, sizeof(float));
+
+		}
+
+	} else {
+		scene->sphere_x = permute_column(scene, scene->sphere_x, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_y = permute_column(scene, scene->sphere_y, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_z = permute_column(scene, scene->sphere_z, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_radius = permute_column(scene, scene->sphere_radius, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_red = permute_column(scene, scene->sphere_red, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_green = permute_column(scene, scene->sphere_green, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_blue = permute_column(scene, scene->sphere_blue, builder.indices, scene->num_spheres, sizeof(double));
+		scene->sphere_order = permute_column(scene, scene->sphere_order, builder.indices, scene->num_spheres, sizeof(int));
+
+		if(scene->prepared) {
+			scene->sphere_c = permute_column(scene, scene->sphere_c, builder.indices, scene->num_spheres, sizeof(double));
+
+		}
+
+	}
+
+	free(builder.indices);
+
+	bvh = malloc(sizeof(Bvh));
+
+	if(bvh == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	bvh->nodes = builder.nodes;
+	bvh->num_nodes = builder.num_nodes;
+
+	return bvh;
+
+}
+
+
+/**
+ * bvh_refit
+ *
+ * @param bvh - hierarchy built over the scene's spheres
+ * @param scene - render scene whose spheres moved, the number of spheres and their order in the
+ * columns must be the ones the hierarchy was built for
+ * @returns void
+ * @description recomputes every box bottom up around the spheres' current positions and radii,
+ * keeping the tree as it is. Much cheaper than a rebuild, but the boxes may overlap more the
+ * further the spheres move from where they were when the hierarchy was built. Children are always
+ * stored after their parent, so one backward pass over the nodes sees every child first.
+ */
+void bvh_refit(Bvh *bvh, RenderScene *scene) {
+	BvhNode *node, *left, *right;
+	Bounds bounds;
+	double min[3], max[3];
+	int index, sphere, axis;
+
+	for(index = bvh->num_nodes - 1; index >= 0; index--) {
+		node = &bvh->nodes[index];
+
+		if(node->count > 0) {
+			bounds_empty(&bounds);
+
+			for(sphere = node->first; sphere < node->first + node->count; sphere++) {
+				sphere_bounds(scene, sphere, min, max);
+				bounds_grow(&bounds, min, max);
+
+			}
+
+			store_bounds(node, &bounds);
+
+		} else {
+			// Child boxes are already rounded outward, their union needs no further rounding
+			left = &bvh->nodes[node->first];
+			right = &bvh->nodes[node->first + 1];
+
+			for(axis = 0; axis < 3; axis++) {
+				node->min[axis] = (left->min[axis] < right->min[axis]) ? left->min[axis] : right->min[axis];
+				node->max[axis] = (left->max[axis] > right->max[axis]) ? left->max[axis] : right->max[axis];
+
+			}
+
+		}
+
+	}
+
+}
+
+
+/**
+ * bvh_free
+ *
+ * @param bvh - hierarchy built by bvh_build, may be NULL
+ * @returns void
+ * @description releases a bounding volume hierarchy
+ */
+void bvh_free(Bvh *bvh) {
+	if(bvh != NULL) {
+		free(bvh->nodes);
+		free(bvh);
+
+	}
+
+}
@@ -0,0 +1,51 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: bvh.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef bvh_h
+#define bvh_h
+
+// Scenes with fewer spheres than this are scanned linearly, the packet kernels win there
+#define BVH_MIN_SPHERES 16
+
+// Deepest path the builder creates, traversal stacks are sized from it
+#define BVH_MAX_DEPTH 96
+
+/**
+ * BvhNode
+ *
+ * @description axis aligned box around a group of spheres. Bounds are stored in single precision
+ * rounded outward so a node always contains its spheres. Interior nodes have count 0 and first is
+ * the index of the left child, the right child follows it. Leaves hold count spheres starting at
+ * first in the scene's sphere columns.
+ */
+typedef struct BvhNode {
+	float min[3];
+	float max[3];
+	int first;
+	int count;
+
+} BvhNode;
+
+
+/**
+ * Bvh
+ *
+ * @description bounding volume hierarchy over a RenderScene's spheres, node 0 is the root
+ */
+typedef struct Bvh {
+	BvhNode *nodes;
+	int num_nodes;
+
+} Bvh;
+
+// function declarations
+Bvh *bvh_build(RenderScene *scene, ThreadPool *pool);
+void bvh_refit(Bvh *bvh, RenderScene *scene);
+void bvh_free(Bvh *bvh);
+
+#endif
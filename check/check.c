@@ -0,0 +1,324 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: check.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\ppm\ppm.h"
+#include "..\scene\scene.h"
+#include "..\simd\simd.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "..\binscene\binscene.h"
+#include "..\raycaster\raycaster.h"
+#include "check.h"
+
+/**
+ * check_scene
+ *
+ * @param num_spheres - number of spheres
+ * @returns a newly allocated RenderScene with a camera and a row of spheres in front of it
+ * @description builds the scene every check writes as a binary scene file
+ */
+static RenderScene *check_scene(int num_spheres) {
+	RenderScene *scene;
+	Object object;
+	int index;
+
+	scene = scene_create();
+	memset(&object, 0, sizeof(Object));
+	object.type = "camera";
+	object.properties.camera.width = 2.0;
+	object.properties.camera.height = 2.0;
+	scene_add(scene, &object, 0);
+
+	for(index = 0; index < num_spheres; index++) {
+		memset(&object, 0, sizeof(Object));
+		object.type = "sphere";
+		object.properties.sphere.color[0] = 1.0;
+		object.properties.sphere.position[0] = -1.0 + 2.0 * (index + 0.5) / num_spheres;
+		object.properties.sphere.position[2] = 4.0;
+		object.properties.sphere.radius = 1.0 / num_spheres;
+		scene_add(scene, &object, index + 1);
+
+	}
+
+	scene_finish(scene);
+
+	return scene;
+
+}
+
+
+/**
+ * check_load
+ *
+ * @returns how the child process loading the binary scene file ended
+ * @description loads and renders the binary scene file in a child process, so a scene the loader
+ * rejects, or one that crashes the renderer, ends the child rather than the checks
+ */
+static CheckOutcome check_load(void) {
+	RenderScene *scene;
+	Image image;
+	pid_t child;
+	double origin[3] = {0.0, 0.0, 0.0};
+	int status, num_objects;
+
+	fflush(stdout);
+	child = fork();
+
+	if(child < 0) {
+		fprintf(stderr, "Error, unable to start a check process.\n");
+		exit(-1);
+
+	} else if(child == 0) {
+		scene = binscene_load(CHECK_SCENE_FILE, &num_objects);
+		scene_prepare(scene, origin);
+		simd_select(SIMD_AVX512);
+
+		image.width = CHECK_IMAGE_SIZE;
+		image.height = CHECK_IMAGE_SIZE;
+		image.max_color = 255;
+		image.image_data = calloc(CHECK_IMAGE_SIZE * CHECK_IMAGE_SIZE, sizeof(Pixel));
+
+		if(image.image_data == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		raycaster(scene, &image, NULL);
+		exit(0);
+
+	}
+
+	if(waitpid(child, &status, 0) < 0) {
+		fprintf(stderr, "Error, lost a check process.\n");
+		exit(-1);
+
+	}
+
+	if(WIFEXITED(status)) {
+		return (WEXITSTATUS(status) == 0) ? OUTCOME_RENDERED : OUTCOME_REJECTED;
+
+	}
+
+	return(OUTCOME_CRASHED);
+
+}
+
+
+/**
+ * check_tree
+ *
+ * @returns 1 when the check passes, 0 otherwise
+ * @description a hierarchy built by bvh_build is a tree and must load and render
+ */
+static int check_tree(void) {
+	RenderScene *scene;
+	double origin[3] = {0.0, 0.0, 0.0};
+
+	scene = check_scene(64);
+	scene_prepare(scene, origin);
+	scene->bvh = bvh_build(scene, NULL);
+	binscene_write(CHECK_SCENE_FILE, scene, scene->num_spheres + 1);
+	scene_free(scene);
+
+	return(check_load() == OUTCOME_RENDERED);
+
+}
+
+
+/**
+ * check_shared_children
+ *
+ * @returns 1 when the check passes, 0 otherwise
+ * @description a stored hierarchy whose nodes share children is not a tree and must be rejected.
+ * Level j of the crafted hierarchy is an interior node at 3j whose children are a leaf at 3j + 2
+ * and the next level at 3j + 3. Nothing points at the interior node at 3j + 1, it sits at depth 0
+ * and points at the same pair of children. Every box covers everything, so a ray walks all
+ * CHECK_DAG_LEVELS levels, deeper than the traversal stack.
+ */
+static int check_shared_children(void) {
+	RenderScene *scene;
+	BvhNode *nodes;
+	int num_nodes, level, index;
+
+	// A file holds at most two nodes per sphere
+	scene = check_scene(2 * CHECK_DAG_LEVELS);
+	num_nodes = 3 * CHECK_DAG_LEVELS + 1;
+	nodes = calloc(num_nodes, sizeof(BvhNode));
+	scene->bvh = malloc(sizeof(Bvh));
+
+	if((nodes == NULL) || (scene->bvh == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(index = 0; index < num_nodes; index++) {
+		nodes[index].min[0] = nodes[index].min[1] = nodes[index].min[2] = -1e30f;
+		nodes[index].max[0] = nodes[index].max[1] = nodes[index].max[2] = 1e30f;
+		nodes[index].first = 0;
+		nodes[index].count = 1;
+
+	}
+
+	for(level = 0; level < CHECK_DAG_LEVELS; level++) {
+		nodes[3 * level].first = 3 * level + 2;
+		nodes[3 * level].count = 0;
+		nodes[3 * level + 1].first = 3 * level + 2;
+		nodes[3 * level + 1].count = 0;
+
+	}
+
+	scene->bvh->nodes = nodes;
+	scene->bvh->num_nodes = num_nodes;
+	binscene_write(CHECK_SCENE_FILE, scene, scene->num_spheres + 1);
+	scene_free(scene);
+
+	return(check_load() == OUTCOME_REJECTED);
+
+}
+
+
+/**
+ * check_order
+ *
+ * @param first - order value stored for the first sphere
+ * @returns 1 when the check passes, 0 otherwise
+ * @description an order value is a scene index, one outside the scene or one shared by two
+ * spheres must be rejected before an animation indexes its tables with it
+ */
+static int check_order(int first) {
+	RenderScene *scene;
+
+	scene = check_scene(4);
+	scene->sphere_order[0] = first;
+	binscene_write(CHECK_SCENE_FILE, scene, scene->num_spheres + 1);
+	scene_free(scene);
+
+	return(check_load() == OUTCOME_REJECTED);
+
+}
+
+
+/**
+ * check_render_json
+ *
+ * @param camera - properties of the camera object, written into the scene file as they are
+ * @returns the newly allocated pixels of the rendered image
+ * @description writes a json scene with the given camera in front of a few spheres and a plane,
+ * then reads it with scene_load and renders it the way raycast does
+ */
+static Pixel *check_render_json(const char *camera) {
+	SceneOptions options;
+	RenderScene *scene;
+	Image image;
+	FILE *fpointer;
+	int num_objects;
+
+	fpointer = fopen(CHECK_JSON_FILE, "w");
+
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, could not open file.\n");
+		exit(-1);
+
+	}
+
+	fprintf(fpointer, "[{\"type\": \"camera\", %s},\n", camera);
+	fprintf(fpointer, "{\"type\": \"sphere\", \"color\": [1, 0, 0], \"position\": [0, 0, 4], \"radius\": 1},\n");
+	fprintf(fpointer, "{\"type\": \"sphere\", \"color\": [0, 1, 0], \"position\": [1, 1, 6], \"radius\": 1},\n");
+	fprintf(fpointer, "{\"type\": \"plane\", \"color\": [0, 0, 1], \"position\": [0, -1, 0], \"normal\": [0, 1, 0]}]\n");
+	fclose(fpointer);
+
+	memset(&options, 0, sizeof(SceneOptions));
+	options.use_bvh = 1;
+	scene = scene_load(CHECK_JSON_FILE, &options, NULL, &num_objects);
+
+	image.width = CHECK_IMAGE_SIZE;
+	image.height = CHECK_IMAGE_SIZE;
+	image.max_color = 255;
+	image.image_data = calloc(CHECK_IMAGE_SIZE * CHECK_IMAGE_SIZE, sizeof(Pixel));
+
+	if(image.image_data == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	raycaster(scene, &image, NULL);
+	scene_free(scene);
+
+	return image.image_data;
+
+}
+
+
+/**
+ * check_camera_position
+ *
+ * @returns 1 when the check passes, 0 otherwise
+ * @description a scene's camera sits at the origin, a camera position in the scene file is
+ * ignored and the image is the same as without it
+ */
+static int check_camera_position(void) {
+	Pixel *origin, *moved;
+	int same;
+
+	origin = check_render_json("\"width\": 2, \"height\": 2");
+	moved = check_render_json("\"width\": 2, \"height\": 2, \"position\": [0, 0, -3]");
+	same = (memcmp(origin, moved, sizeof(Pixel) * CHECK_IMAGE_SIZE * CHECK_IMAGE_SIZE) == 0);
+	free(origin);
+	free(moved);
+
+	return same;
+
+}
+
+
+/**
+ * main
+ *
+ * @returns 0 when every check passes, 1 otherwise
+ * @description regression checks for the scene loaders, run by make check
+ */
+int main(void) {
+	int passed, failed;
+
+	passed = check_tree();
+	printf("- %s: STORED TREE LOADS -\n", passed ? "PASS" : "FAIL");
+	failed = !passed;
+
+	passed = check_shared_children();
+	printf("- %s: HIERARCHY WITH SHARED CHILDREN IS REJECTED -\n", passed ? "PASS" : "FAIL");
+	failed = failed + !passed;
+
+	passed = check_order(0x7ffffff0);
+	printf("- %s: ORDER OUTSIDE THE SCENE IS REJECTED -\n", passed ? "PASS" : "FAIL");
+	failed = failed + !passed;
+
+	passed = check_order(2);
+	printf("- %s: REPEATED ORDER IS REJECTED -\n", passed ? "PASS" : "FAIL");
+	failed = failed + !passed;
+
+	passed = check_camera_position();
+	printf("- %s: CAMERA POSITION OF A SCENE IS IGNORED -\n", passed ? "PASS" : "FAIL");
+	failed = failed + !passed;
+
+	remove(CHECK_SCENE_FILE);
+	remove(CHECK_JSON_FILE);
+
+	return (failed > 0) ? 1 : 0;
+
+}
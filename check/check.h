@@ -0,0 +1,37 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: check.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef check_h
+#define check_h
+
+// Binary scene file the checks write and remove again, in the current directory
+#define CHECK_SCENE_FILE "raycast-check.rscn"
+
+// Json scene file the checks write and remove again, in the current directory
+#define CHECK_JSON_FILE "raycast-check.json"
+
+// Levels of the crafted hierarchy, deeper than any path the traversal stack holds
+#define CHECK_DAG_LEVELS 126
+
+// Size of the image the loaded scenes are rendered into
+#define CHECK_IMAGE_SIZE 16
+
+/**
+ * CheckOutcome
+ *
+ * @description how a check's child process ended, it either loaded and rendered the scene, exited
+ * with an error, or was killed by a signal such as a segmentation fault
+ */
+typedef enum CheckOutcome {
+	OUTCOME_RENDERED = 0,
+	OUTCOME_REJECTED,
+	OUTCOME_CRASHED
+
+} CheckOutcome;
+
+#endif
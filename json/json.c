@@ -10,30 +10,144 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "..\arena\arena.h"
 #include "json.h"
 
-// Line number for error checking purposes
-int line_num;
+/**
+ * JsonReader
+ *
+ * @description source of scene characters, either a file stream read through getc or a file
+ * mapped into memory and read in place. Streams count lines as characters are read, mapped
+ * files only count lines when an error has to be reported.
+ */
+typedef struct JsonReader {
+	FILE *fpointer;
+	const unsigned char *data;
+	size_t length;
+	size_t offset;
+	int line_num;
+
+} JsonReader;
+
+
+// Longest string the parser accepts, 257 characters, plus the terminator
+#define JSON_STRING_SIZE 258
+
+/**
+ * Symbol
+ *
+ * @description index of an interned string in the symbol table
+ */
+typedef enum Symbol {
+	SYMBOL_TYPE = 0,
+	SYMBOL_WIDTH,
+	SYMBOL_HEIGHT,
+	SYMBOL_RADIUS,
+	SYMBOL_COLOR,
+	SYMBOL_POSITION,
+	SYMBOL_NORMAL,
+	SYMBOL_FRAME,
+	SYMBOL_OBJECT,
+	SYMBOL_CAMERA,
+	SYMBOL_SPHERE,
+	SYMBOL_PLANE,
+	SYMBOL_UNKNOWN
+
+} Symbol;
+
+// Symbol table, every key and known type name read in resolves to one of these strings
+static const char *symbols[SYMBOL_UNKNOWN] = {"type", "width", "height", "radius", "color", "position",
+	"normal", "frame", "object", "camera", "sphere", "plane"};
+
+
+/**
+ * line_number
+ *
+ * @param reader - scene source
+ * @returns the line number of the current position, used in error messages
+ * @description a stream's line number is kept up to date by get_char, a mapped file's line number
+ * is worked out by counting the line breaks before the current position
+ */
+static int line_number(JsonReader *reader) {
+	size_t index;
+	int lines = 0;
+
+	if(reader->fpointer != NULL) {
+		return reader->line_num;
+
+	}
+
+	for(index = 0; index < reader->offset; index++) {
+		if((reader->data[index] == '\n') || (reader->data[index] == '\r') || (reader->data[index] == '\f')) {
+			lines = lines + 1;
+
+		}
+
+	}
+
+	return lines;
+
+}
+
+
+/**
+ * reader_close
+ *
+ * @param reader - scene source
+ * @returns void
+ * @description closes the file stream or unmaps the mapped file
+ */
+static void reader_close(JsonReader *reader) {
+	if(reader->fpointer != NULL) {
+		fclose(reader->fpointer);
+
+	} else if(reader->length > 0) {
+		munmap((void *)reader->data, reader->length);
+
+	}
+
+}
+
 
 /**
  * get_char
  *
- * @param file pointer
+ * @param reader - scene source
  * @returns interger value of the ascii character read in
  * @description Reads in a character from an input stream, checks if the character is a newline, 
  * carriage return, or linefeed and adds 1 to the line number counter (line_num).
  * If an end-of-file is encountered, prompt the user exit program.
  */
-int get_char(FILE *fpointer) {
-	int token = getc(fpointer);
+static inline int get_char(JsonReader *reader) {
+	int token;
+
+	if(reader->fpointer == NULL) {
+		if(reader->offset < reader->length) {
+			token = reader->data[reader->offset];
+			reader->offset = reader->offset + 1;
+			return token;
+
+		}
+
+		token = EOF;
+
+	} else {
+		token = getc(reader->fpointer);
+
+	}
 	
 	if((token == '\n') || (token == '\r') || (token == '\f')) {
-		line_num = line_num + 1;
+		reader->line_num = reader->line_num + 1;
 		
 	} else if(token == EOF) {
-		fprintf(stderr, "Error, line number %d; unexpected end-of-file.\n", line_num);
+		fprintf(stderr, "Error, line number %d; unexpected end-of-file.\n", line_number(reader));
 		// Close file stream flush all buffers
-		fclose(fpointer);
+		reader_close(reader);
 		exit(-1);
 		
 	}
@@ -41,26 +155,57 @@ int get_char(FILE *fpointer) {
 	return token;
 	
 } 
+
+
+/**
+ * unget_char
+ *
+ * @param reader - scene source
+ * @param token - the character last read by get_char
+ * @returns void
+ * @description pushes the last character read back onto the source
+ */
+static inline void unget_char(JsonReader *reader, int token) {
+	if(reader->fpointer == NULL) {
+		reader->offset = reader->offset - 1;
+
+	} else {
+		ungetc(token, reader->fpointer);
+
+	}
+
+}
  
  
 /**
  * skip_whitespace
  *
- * @param file pointer
+ * @param reader - scene source
  * @returns void
  * @description Reads in a character from an input stream, checks if the character is a newline, 
  * carriage return, or linefeed and adds 1 to the line number counter (line_num).
  * If an end-of-file is encountered, prompt the user exit program.
  */
-void skip_whitespace(FILE *fpointer) {
-	int token = get_char(fpointer);
+static void skip_whitespace(JsonReader *reader) {
+	int token;
+
+	// Mapped files are scanned in place, end-of-file is reported by get_char below
+	if(reader->fpointer == NULL) {
+		while((reader->offset < reader->length) && (isspace(reader->data[reader->offset]) != 0)) {
+			reader->offset = reader->offset + 1;
+
+		}
+
+	}
+
+	token = get_char(reader);
 	
 	while(isspace(token) != 0){
-		token = get_char(fpointer);
+		token = get_char(reader);
 		
 	}
 	
-	ungetc(token, fpointer);
+	unget_char(reader, token);
 	
 }
 
@@ -68,49 +213,49 @@ void skip_whitespace(FILE *fpointer) {
 /**
  * get_string
  *
- * @param file pointer
- * @returns string of characters delimited by "... "
+ * @param reader - scene source
+ * @param buffer - receives the string, JSON_STRING_SIZE characters
+ * @returns void
  * @description Reads in a stream of characters delimited by quotation marks. Validates against the existence
  * of escape sequence codes, strings longer then 256 characters, and non-ascii characters. 
  */
-char *get_string(FILE *fpointer){
-	char buffer[256];
+static void get_string(JsonReader *reader, char *buffer){
 	int token, i = 0;
 	// Read in character advance the stream position indicator
-	token = get_char(fpointer);
+	token = get_char(reader);
 	
 	if(token != '"') {
-		fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_num, token, '"');
+		fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_number(reader), token, '"');
 		// Close file stream flush all buffers
-		fclose(fpointer);		
+		reader_close(reader);		
 		exit(-1);
 		
 	} else {
 		// Read in character advance the stream position indicator
-		token = get_char(fpointer);
+		token = get_char(reader);
 		
 		while(token != '"'){
 			 // String exceeds the buffer size
 			if(i > 256) {
-				fprintf(stderr, "Error, line number %d; Strings with a length greater than 256 characters are not supported.\n", line_num);
+				fprintf(stderr, "Error, line number %d; Strings with a length greater than 256 characters are not supported.\n", line_number(reader));
 				// Close file stream flush all buffers
-				fclose(fpointer);
+				reader_close(reader);
 				exit(-1);	
 				
 			}
 			// String contains escape sequence code(s)
 			if(token == '\\') {
-				fprintf(stderr, "Error, line number %d; Strings with escape character codes are not supported.\n", line_num);
+				fprintf(stderr, "Error, line number %d; Strings with escape character codes are not supported.\n", line_number(reader));
 				// Close file stream flush all buffers
-				fclose(fpointer);
+				reader_close(reader);
 				exit(-1);
 				
 			}
 			// String is not an ascii character
 			if((token < 32) || (token > 126)) {
-				fprintf(stderr, "Error, line number %d; Strings can contain ascii characters only.\n", line_num);
+				fprintf(stderr, "Error, line number %d; Strings can contain ascii characters only.\n", line_number(reader));
 				// Close file stream flush all buffers
-				fclose(fpointer);
+				reader_close(reader);
 				exit(-1);	
 				
 			}
@@ -119,114 +264,348 @@ char *get_string(FILE *fpointer){
 			i = i + 1;
 			
 			// Read in character advance the stream position indicator
-			token = get_char(fpointer);
+			token = get_char(reader);
 			 
 		}
 		
 	}
 	 
 	buffer[i] = 0;
-	return strdup(buffer);
 	
  }
+
+
+/**
+ * intern
+ *
+ * @param string - string read in by get_string
+ * @returns the symbol matching the string, SYMBOL_UNKNOWN otherwise
+ * @description looks a string up in the symbol table
+ */
+static Symbol intern(const char *string) {
+	int symbol;
+	
+	for(symbol = 0; symbol < SYMBOL_UNKNOWN; symbol++) {
+		if(strcmp(string, symbols[symbol]) == 0) {
+			return (Symbol)symbol;
+			
+		}
+		
+	}
+	
+	return SYMBOL_UNKNOWN;
+	
+}
  
  
+/**
+ * parse_double
+ *
+ * @param reader - mapped scene source
+ * @param dbl - receives the number
+ * @returns 1 if a number was read, 0 if the characters at the current position are not a number
+ * @description locale independent replacement for fscanf("%lf") over a mapped file. Accepts an
+ * optional sign, digits with an optional decimal point, and an optional exponent, consuming the
+ * same characters glibc's fscanf does. Numbers with at
+ * most 19 significant digits whose value and power of ten are exactly representable are computed
+ * directly with a single correctly rounded multiply or divide; anything else (very long mantissas,
+ * large exponents, inf, nan, hexadecimal) is handed to strtod, the program never changes its
+ * locale from "C" so strtod agrees with fscanf.
+ */
+static int parse_double(JsonReader *reader, double *dbl) {
+	static const double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	const unsigned char *cursor = reader->data + reader->offset;
+	const unsigned char *end = reader->data + reader->length;
+	unsigned long long mantissa = 0;
+	int negative = 0, digits = 0, significant = 0, exponent = 0, exponent_value = 0, exponent_negative = 0;
+	char buffer[512], *stop;
+	size_t length;
+	double value;
+
+	if((cursor < end) && ((*cursor == '+') || (*cursor == '-'))) {
+		negative = (*cursor == '-');
+		cursor++;
+
+	}
+
+	// Integer part
+	while((cursor < end) && (isdigit(*cursor) != 0)) {
+		if((significant > 0) || (*cursor != '0')) {
+			if(significant < 19) {
+				mantissa = mantissa * 10 + (*cursor - '0');
+
+			} else {
+				exponent = exponent + 1;
+
+			}
+
+			significant = significant + 1;
+
+		}
+
+		digits = digits + 1;
+		cursor++;
+
+	}
+
+	// Fraction part
+	if((cursor < end) && (*cursor == '.')) {
+		cursor++;
+
+		while((cursor < end) && (isdigit(*cursor) != 0)) {
+			if((significant > 0) || (*cursor != '0')) {
+				if(significant < 19) {
+					mantissa = mantissa * 10 + (*cursor - '0');
+					exponent = exponent - 1;
+
+				}
+
+				significant = significant + 1;
+
+			} else {
+				exponent = exponent - 1;
+
+			}
+
+			digits = digits + 1;
+			cursor++;
+
+		}
+
+	}
+
+	if(digits == 0) {
+		// Not a decimal number, infinities, nans, and malformed input go through strtod
+		goto fallback;
+
+	}
+
+	// Exponent part
+	if((cursor < end) && ((*cursor == 'e') || (*cursor == 'E'))) {
+		cursor++;
+
+		if((cursor < end) && ((*cursor == '+') || (*cursor == '-'))) {
+			exponent_negative = (*cursor == '-');
+			cursor++;
+
+		}
+
+		// Like fscanf, a marker without digits is consumed and leaves the exponent at zero
+		while((cursor < end) && (isdigit(*cursor) != 0)) {
+			if(exponent_value < 100000) {
+				exponent_value = exponent_value * 10 + (*cursor - '0');
+
+			}
+
+			cursor++;
+
+		}
+
+		exponent = exponent + (exponent_negative ? -exponent_value : exponent_value);
+
+	}
+
+	if((cursor < end) && ((*cursor == 'x') || (*cursor == 'X')) && (digits == 1) && (significant == 0)) {
+		// Hexadecimal floating point
+		goto fallback;
+
+	}
+
+	if((significant <= 19) && (mantissa <= (1ULL << 53)) && (exponent >= -22) && (exponent <= 22)) {
+		value = (double)mantissa;
+		value = (exponent < 0) ? value / powers[-exponent] : value * powers[exponent];
+		*dbl = negative ? -value : value;
+		reader->offset = cursor - reader->data;
+		return(1);
+
+	}
+
+	// Decimal number that needs full precision conversion, strtod stops before a dangling exponent
+	// marker that was already consumed above
+	length = cursor - (reader->data + reader->offset);
+
+	if(length < sizeof(buffer)) {
+		memcpy(buffer, reader->data + reader->offset, length);
+		buffer[length] = 0;
+		*dbl = strtod(buffer, NULL);
+		reader->offset = cursor - reader->data;
+		return(1);
+
+	}
+
+fallback:
+	length = end - (reader->data + reader->offset);
+	length = (length < sizeof(buffer) - 1) ? length : sizeof(buffer) - 1;
+	memcpy(buffer, reader->data + reader->offset, length);
+	buffer[length] = 0;
+
+	value = strtod(buffer, &stop);
+
+	if(stop == buffer) {
+		return(0);
+
+	}
+
+	if((cursor < end) && ((*cursor == 'x') || (*cursor == 'X'))) {
+		if(stop <= buffer + (cursor - (reader->data + reader->offset)) + 1) {
+			// "0x" without hexadecimal digits is not a number for fscanf
+			return(0);
+
+		}
+
+		// fscanf also swallows a binary exponent marker without digits
+		if((*stop == 'p') || (*stop == 'P')) {
+			stop++;
+
+			if((*stop == '+') || (*stop == '-')) {
+				stop++;
+
+			}
+
+		}
+
+	}
+
+	*dbl = value;
+	reader->offset = reader->offset + (stop - buffer);
+
+	return(1);
+
+}
+
+
 /**
  * get_double
  *
- * @param file pointer
+ * @param reader - scene source
  * @returns double
  * @description Reads in a double precsion floating point number, if none are found throws error
  * exits the program. 
  */
-double get_double(FILE *fpointer){
-	 double dbl;
-	 
-	 if(fscanf(fpointer, "%lf", &dbl) == 0) {
-		fprintf(stderr, "Error, line number %d; expected numeric value.\n", line_num);
+static double get_double(JsonReader *reader){
+	double dbl = 0;
+	int result;
+	
+	if(reader->fpointer != NULL) {
+		result = fscanf(reader->fpointer, "%lf", &dbl);
+		
+	} else if(reader->offset >= reader->length) {
+		// Nothing left to convert, end-of-file is reported by the next get_char
+		result = EOF;
+		
+	} else {
+		result = parse_double(reader, &dbl);
+		
+	}
+	
+	if(result == 0) {
+		fprintf(stderr, "Error, line number %d; expected numeric value.\n", line_number(reader));
 		// Close file stream flush all buffers
-		fclose(fpointer);
+		reader_close(reader);
 		exit(-1);		
 		
-	 } else {
-		 return dbl;
-		 
-	 }
-	 
- }
+	} else {
+		return dbl;
+		
+	}
+	
+}
+ 
+ 
+/**
+ * get_index
+ *
+ * @param reader - scene source
+ * @returns the number read in
+ * @description reads in a number that counts something, a frame or an object index, and exits
+ * unless it is a whole number from 0 up
+ */
+static int get_index(JsonReader *reader){
+	double dbl;
+	
+	dbl = get_double(reader);
+	
+	if(!((dbl >= 0) && (dbl <= INT_MAX) && (dbl == (int)dbl))) {
+		fprintf(stderr, "Error, line number %d; expected a whole number of 0 or more.\n", line_number(reader));
+		// Close file stream flush all buffers
+		reader_close(reader);
+		exit(-1);
+		
+	}
+	
+	return (int)dbl;
+	
+}
  
  
 /**
  * get_vector
  *
- * @param file pointer
- * @returns double[3]
+ * @param reader - scene source
+ * @param vector - receives the three components
+ * @returns void
  * @description Reads in an array with the format pattern [x, y, z] and parses into an array of	
  * doubles.
  */
-double *get_vector(FILE *fpointer){
-	// Allocate memory for vector array of doubles
-	double *vector = malloc(3 * sizeof(double));
-
+static void get_vector(JsonReader *reader, double vector[3]){
 	int token;
 	
-	token = get_char(fpointer);
+	token = get_char(reader);
 	
 	if(token != '[') {
-		fprintf(stderr, "Error, line number %d; error reading in vector. Unexpected character '%c', expected character '%c'.\n", line_num, token, '[');
+		fprintf(stderr, "Error, line number %d; error reading in vector. Unexpected character '%c', expected character '%c'.\n", line_number(reader), token, '[');
 		// Close file stream flush all buffers
-		fclose(fpointer);		
+		reader_close(reader);		
 		exit(-1);
 		
 	}	
-	skip_whitespace(fpointer);
+	skip_whitespace(reader);
 	
-	vector[0] = get_double(fpointer);
+	vector[0] = get_double(reader);
 	
-	skip_whitespace(fpointer);
+	skip_whitespace(reader);
 	
-	token = get_char(fpointer);
+	token = get_char(reader);
 	
 	if(token != ',') {
-		fprintf(stderr, "Error, line number %d; error reading in vector. Unexpected character '%c', expected character '%c'.\n", line_num, token, ',');
+		fprintf(stderr, "Error, line number %d; error reading in vector. Unexpected character '%c', expected character '%c'.\n", line_number(reader), token, ',');
 		// Close file stream flush all buffers
-		fclose(fpointer);		
+		reader_close(reader);		
 		exit(-1);
 		
 	}
-	skip_whitespace(fpointer);
+	skip_whitespace(reader);
 	
-	vector[1] = get_double(fpointer);
+	vector[1] = get_double(reader);
 	
-	skip_whitespace(fpointer);
+	skip_whitespace(reader);
 	
-	token = get_char(fpointer);
+	token = get_char(reader);
 	
 	if(token != ',') {
-		fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_num, token, ',');
+		fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_number(reader), token, ',');
 		// Close file stream flush all buffers
-		fclose(fpointer);		
+		reader_close(reader);		
 		exit(-1);
 		
 	}
-	skip_whitespace(fpointer);
+	skip_whitespace(reader);
 	
-	vector[2] = get_double(fpointer);
+	vector[2] = get_double(reader);
 	
-	skip_whitespace(fpointer);
+	skip_whitespace(reader);
 
-	token = get_char(fpointer);
+	token = get_char(reader);
 	
 	if(token != ']') {
-		fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_num, token, ']');
+		fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_number(reader), token, ']');
 		// Close file stream flush all buffers
-		fclose(fpointer);		
+		reader_close(reader);		
 		exit(-1);
 		
 	}		
 	
-	return vector;
-	
  }
 
  
@@ -237,7 +616,7 @@ double *get_vector(FILE *fpointer){
  * @returns 0 if an element is not within the acceptable tolerances 0 to 1.0 and 1 otherwise
  * @description check if color value is within the acceptable tolerances 0 to 1.0
  */
- int color_tolerance(double color_v[]){
+ static int color_tolerance(double color_v[]){
 	int index;
 	 
 	for(index = 0; index < 3; index++) {
@@ -255,10 +634,103 @@ double *get_vector(FILE *fpointer){
 
  
 /**
- * json_read_scene
+ * scene_init
  *
- * @param file pointer
- * @param array of Object
+ * @param scene - scene to initialize
+ * @returns void
+ * @description prepares an empty scene
+ */
+void scene_init(Scene *scene) {
+	arena_init(&scene->arena, ARENA_BLOCK_SIZE);
+	scene->blocks = NULL;
+	scene->num_blocks = 0;
+	scene->max_blocks = 0;
+	scene->num_objects = 0;
+
+}
+
+
+/**
+ * scene_append
+ *
+ * @param scene - scene to grow
+ * @returns pointer to a new zeroed object at the end of the scene
+ * @description appends an object, a new block of SCENE_BLOCK_OBJECTS objects is taken from the
+ * arena whenever the last block is full. The block directory doubles when it runs out of room,
+ * the old directory stays in the arena and is freed with the rest of the scene.
+ */
+Object *scene_append(Scene *scene) {
+	Object **blocks;
+	Object *object;
+
+	if(scene->num_objects == scene->num_blocks * SCENE_BLOCK_OBJECTS) {
+		if(scene->num_blocks == scene->max_blocks) {
+			scene->max_blocks = (scene->max_blocks > 0) ? scene->max_blocks * 2 : 16;
+			blocks = arena_alloc(&scene->arena, sizeof(Object *) * scene->max_blocks);
+
+			if(scene->num_blocks > 0) {
+				memcpy(blocks, scene->blocks, sizeof(Object *) * scene->num_blocks);
+
+			}
+
+			scene->blocks = blocks;
+
+		}
+
+		scene->blocks[scene->num_blocks] = arena_alloc(&scene->arena, sizeof(Object) * SCENE_BLOCK_OBJECTS);
+		scene->num_blocks = scene->num_blocks + 1;
+
+	}
+
+	object = &scene->blocks[scene->num_objects / SCENE_BLOCK_OBJECTS][scene->num_objects % SCENE_BLOCK_OBJECTS];
+	memset(object, 0, sizeof(Object));
+	scene->num_objects = scene->num_objects + 1;
+
+	return object;
+
+}
+
+
+/**
+ * scene_object
+ *
+ * @param scene - scene
+ * @param index - object index, 0 to num_objects - 1
+ * @returns pointer to the object
+ * @description random access to a scene's objects
+ */
+Object *scene_object(Scene *scene, int index) {
+	return &scene->blocks[index / SCENE_BLOCK_OBJECTS][index % SCENE_BLOCK_OBJECTS];
+
+}
+
+
+/**
+ * scene_release
+ *
+ * @param scene - scene to release
+ * @returns void
+ * @description frees every object and type string of the scene at once, the scene is left empty
+ */
+void scene_release(Scene *scene) {
+	arena_release(&scene->arena);
+	scene->blocks = NULL;
+	scene->num_blocks = 0;
+	scene->max_blocks = 0;
+	scene->num_objects = 0;
+
+}
+
+
+/**
+ * parse_scene
+ *
+ * @param reader - scene source
+ * @param scene - Scene the objects are appended to, there is no limit on the number of objects
+ * @param handler - when not NULL objects are streamed to the handler instead of appended to scene
+ * @param context - passed through to the handler
+ * @param motion - storage of the keyframe being read when the source is a motion file, NULL
+ * otherwise. Keyframes are always streamed, and only they accept the frame and object keys.
  * @returns integer number of item read-in
  * @description reads in a scene of objects formatted using JavaScript Object Notation (JSON)
  * - Accepts [ empty scene ]
@@ -267,178 +739,213 @@ double *get_vector(FILE *fpointer){
  * - Accepts comma and non-comma separated name:value pairs
  * - Whitespace insensitive
  */ 
-int json_read_scene(FILE *fpointer, Object objects[]) {
-	int token, index;
-	double *vector;
-	char *name, *value;
+static int parse_scene(JsonReader *reader, Scene *scene, ObjectHandler handler, void *context, MotionKey *motion) {
+	int token;
+	double vector[3];
+	char name[JSON_STRING_SIZE], value[JSON_STRING_SIZE];
+	char type_name[JSON_STRING_SIZE];
+	Symbol key, type;
+	Object *object, streamed;
+	int num_objects;
 	
-	index = 0;
+	num_objects = 0;
 	
 	// Skip whitespace(s) read in the first character
-	skip_whitespace(fpointer);
-	token = get_char(fpointer);
+	skip_whitespace(reader);
+	token = get_char(reader);
 	
 	// Check to see of the first character is an opening
 	// brace denoting the start of a scene
 	if(token != '[') {
-		fprintf(stderr, "Error, line number %d; invalid scene definition '%c', expected character '%c'.\n", line_num, token, '[');
+		fprintf(stderr, "Error, line number %d; invalid scene definition '%c', expected character '%c'.\n", line_number(reader), token, '[');
 		// Close file stream flush all buffers
-		fclose(fpointer);		
+		reader_close(reader);		
 		exit(-2);
 		
 	}
 	
-	skip_whitespace(fpointer);
-	token = get_char(fpointer);
+	skip_whitespace(reader);
+	token = get_char(reader);
 		
 	// Check for an empty scene [no objects]
 	if(token != ']') {
-		ungetc(token, fpointer);
+		unget_char(reader, token);
 		
 	}
 		
 	// Empty scene not detected, loop through the scene until a 
 	// closing brace is encountered
 	while(token != ']') {
-		skip_whitespace(fpointer);
-		token = get_char(fpointer);
+		skip_whitespace(reader);
+		token = get_char(reader);
 		
 		// Determine if the character read in is a valid begining of an object
 		if(token != '{') {
-			fprintf(stderr, "Error, line number %d; invalid object definition '%c', expected character '%c'.\n", line_num, token, '{');
+			fprintf(stderr, "Error, line number %d; invalid object definition '%c', expected character '%c'.\n", line_number(reader), token, '{');
 			// Close file stream flush all buffers
-			fclose(fpointer);		
+			reader_close(reader);		
 			exit(-2);
 			
 		}
 		
-		skip_whitespace(fpointer);
+		// Storage for the object, zeroed so that an object without a type has a NULL type. A
+		// streamed object reuses the same storage for every object of the scene
+		if(motion != NULL) {
+			// Only keyframes of a motion file name the object they move
+			memset(motion, 0, sizeof(MotionKey));
+			motion->target = -1;
+			object = &motion->object;
+			
+		} else if(handler != NULL) {
+			object = &streamed;
+			memset(object, 0, sizeof(Object));
+			
+		} else {
+			object = scene_append(scene);
+			
+		}
+		
+		skip_whitespace(reader);
 		// Read in a character advance the stream position indicator
-		token = get_char(fpointer);	
+		token = get_char(reader);	
 		
 		while(token != '}') {
 			// If the next character is a '"' which means a string move indicator back one position then read in the string
 			if(token == '"') {
-				ungetc(token, fpointer);			
+				unget_char(reader, token);			
 
 			}
 			
-			name = get_string(fpointer);
+			get_string(reader, name);
+			key = intern(name);
 			
-			if(strcmp(name, "type") == 0){
-				skip_whitespace(fpointer);
+			if(key == SYMBOL_TYPE){
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 				
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-3);
 					
 				} else {
-					skip_whitespace(fpointer);
-					value = get_string(fpointer);
-					objects[index].type = value;
+					skip_whitespace(reader);
+					get_string(reader, value);
+					type = intern(value);
+					
+					// Known types point into the symbol table, anything else is copied
+					if((type >= SYMBOL_CAMERA) && (type < SYMBOL_UNKNOWN)) {
+						object->type = (char *)symbols[type];
+						
+					} else if(handler != NULL) {
+						strcpy(type_name, value);
+						object->type = type_name;
+						
+					} else {
+						object->type = arena_strdup(&scene->arena, value);
+						
+					}
 					
 				}
 	   
-			} else if(strcmp(name, "width") == 0) {
-				skip_whitespace(fpointer);
-				token = get_char(fpointer);
+			} else if(key == SYMBOL_WIDTH) {
+				skip_whitespace(reader);
+				token = get_char(reader);
 
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-3);
 					
 				} else {
-					skip_whitespace(fpointer);
-					objects[index].properties.camera.width = get_double(fpointer);
+					skip_whitespace(reader);
+					object->properties.camera.width = get_double(reader);
 					
 				}
 				
-			} else if(strcmp(name, "height") == 0) {
-				skip_whitespace(fpointer);
+			} else if(key == SYMBOL_HEIGHT) {
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-3);
 					
 				} else {
-					skip_whitespace(fpointer);
-					objects[index].properties.camera.height = get_double(fpointer);
+					skip_whitespace(reader);
+					object->properties.camera.height = get_double(reader);
 					
 				}
 				
-			} else if(strcmp(name, "radius") == 0) {
-				skip_whitespace(fpointer);
+			} else if(key == SYMBOL_RADIUS) {
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-1);
 					
 				} else {
-					skip_whitespace(fpointer);
-					objects[index].properties.sphere.radius = get_double(fpointer);
+					skip_whitespace(reader);
+					object->properties.sphere.radius = get_double(reader);
 					
 				}
 			
-			} else if(strcmp(name, "color") == 0) {
-				skip_whitespace(fpointer);
+			} else if(key == SYMBOL_COLOR) {
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-1);
 					
 				} else {
-					skip_whitespace(fpointer);
-					vector = get_vector(fpointer);
+					skip_whitespace(reader);
+					get_vector(reader, vector);
 					
 					// Validates against object defintions without a type defined. That is all 
 					// objects and object properties associated to a type value of NULL are ignored
-					if(objects[index].type != NULL) {
-						if(strcmp(objects[index].type, "sphere") == 0) {
+					if(object->type != NULL) {
+						if(object->type == symbols[SYMBOL_SPHERE]) {
 							// Check color tolerance range of 0 to 1.0
 							if(color_tolerance(vector) != 1) {
 								fprintf(stderr, "Error, invalid color tolerance in sphere color array.\n");
 								// Close file stream flush all buffers
-								fclose(fpointer);		
+								reader_close(reader);		
 								exit(-1);
 								
 							} else {
-								objects[index].properties.sphere.color[0] = vector[0];
-								objects[index].properties.sphere.color[1] = vector[1];
-								objects[index].properties.sphere.color[2] = vector[2];	
+								object->properties.sphere.color[0] = vector[0];
+								object->properties.sphere.color[1] = vector[1];
+								object->properties.sphere.color[2] = vector[2];	
 								
 							}
 								
 							
-						} else if(strcmp(objects[index].type, "plane") == 0) {
+						} else if(object->type == symbols[SYMBOL_PLANE]) {
 							// Check color tolerance range of 0 to 1.0
 							if(color_tolerance(vector) != 1) {
 								fprintf(stderr, "Error, invalid color tolerance in plane color array.\n");
 								// Close file stream flush all buffers
-								fclose(fpointer);		
+								reader_close(reader);		
 								exit(-1);							
 								
 							} else {
-								objects[index].properties.plane.color[0] = vector[0];
-								objects[index].properties.plane.color[1] = vector[1];
-								objects[index].properties.plane.color[2] = vector[2];
+								object->properties.plane.color[0] = vector[0];
+								object->properties.plane.color[1] = vector[1];
+								object->properties.plane.color[2] = vector[2];
 								
 							}
 			
@@ -448,33 +955,38 @@ int json_read_scene(FILE *fpointer, Object objects[]) {
 			
 				}				
 				
-			} else if(strcmp(name, "position") == 0) {
-				skip_whitespace(fpointer);
+			} else if(key == SYMBOL_POSITION) {
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-1);
 					
 				} else {
-					skip_whitespace(fpointer);
-					vector = get_vector(fpointer);
+					skip_whitespace(reader);
+					get_vector(reader, vector);
 					
 					// Validates against object defintions without a type defined. That is all 
 					// objects and object properties associated to a type value of NULL are ignored
-					if(objects[index].type != NULL){
-						if(strcmp(objects[index].type, "sphere") == 0) {
-							objects[index].properties.sphere.position[0] = vector[0];
-							objects[index].properties.sphere.position[1] = vector[1];
-							objects[index].properties.sphere.position[2] = vector[2];					
+					if(object->type != NULL){
+						if(object->type == symbols[SYMBOL_SPHERE]) {
+							object->properties.sphere.position[0] = vector[0];
+							object->properties.sphere.position[1] = vector[1];
+							object->properties.sphere.position[2] = vector[2];					
+							
+						} else if(object->type == symbols[SYMBOL_PLANE]) {
+							object->properties.plane.position[0] = vector[0];
+							object->properties.plane.position[1] = vector[1];
+							object->properties.plane.position[2] = vector[2];
 							
-						} else if(strcmp(objects[index].type, "plane") == 0) {
-							objects[index].properties.plane.position[0] = vector[0];
-							objects[index].properties.plane.position[1] = vector[1];
-							objects[index].properties.plane.position[2] = vector[2];
+						} else if(object->type == symbols[SYMBOL_CAMERA]) {
+							object->properties.camera.position[0] = vector[0];
+							object->properties.camera.position[1] = vector[1];
+							object->properties.camera.position[2] = vector[2];
 							
 						}
 						
@@ -482,73 +994,304 @@ int json_read_scene(FILE *fpointer, Object objects[]) {
 					
 				}				
 				
-			} else if(strcmp(name, "normal") == 0) {
-				skip_whitespace(fpointer);
+			} else if(key == SYMBOL_NORMAL) {
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 
 				if(token != ':') {
-					fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_num, token, ':');
+					fprintf(stderr, "Error, line number %d; unexpected character '%c', expected character '%c'.\n", line_number(reader), token, ':');
 					// Close file stream flush all buffers
-					fclose(fpointer);		
+					reader_close(reader);		
 					exit(-1);
 					
 				} else {
-					skip_whitespace(fpointer);
-					vector = get_vector(fpointer);
+					skip_whitespace(reader);
+					get_vector(reader, vector);
 					
-					objects[index].properties.plane.normal[0] = vector[0];
-					objects[index].properties.plane.normal[1] = vector[1];
-					objects[index].properties.plane.normal[2] = vector[2];
+					object->properties.plane.normal[0] = vector[0];
+					object->properties.plane.normal[1] = vector[1];
+					object->properties.plane.normal[2] = vector[2];
 					
 				}	 
 			   
+			} else if(((key == SYMBOL_FRAME) || (key == SYMBOL_OBJECT)) && (motion != NULL)) {
+				skip_whitespace(reader);
+				// Read in a character and advance the stream position indicator
+				token = get_char(reader);
+
+				if(token != ':') {
+					fprintf(stderr, "Error, line number %d; invalid separator '%c', expected character '%c'.\n", line_number(reader), token, ':');
+					// Close file stream flush all buffers
+					reader_close(reader);		
+					exit(-1);
+					
+				} else if(key == SYMBOL_FRAME) {
+					skip_whitespace(reader);
+					motion->frame = get_index(reader);
+					
+				} else {
+					skip_whitespace(reader);
+					motion->target = get_index(reader);
+					
+				}
+			   
 			} else {
-				fprintf(stderr, "Error, line number %d; invalid type '%s'.\n", line_num, name);
+				fprintf(stderr, "Error, line number %d; invalid type '%s'.\n", line_number(reader), name);
 				// Close file stream flush all buffers
-				fclose(fpointer);		
+				reader_close(reader);		
 				exit(-1);				
 			}
 			
-			skip_whitespace(fpointer);
+			skip_whitespace(reader);
 			// Read in a character and advance the stream position indicator	
-			token = get_char(fpointer);
+			token = get_char(reader);
 			
 			if(token == ',') {
-				skip_whitespace(fpointer);
+				skip_whitespace(reader);
 				// Read in a character and advance the stream position indicator
-				token = get_char(fpointer);
+				token = get_char(reader);
 				
 			}
 			
 		}  // EO While Loop
 		
-		skip_whitespace(fpointer);
+		// The object is complete, hand it to the consumer before reading any further
+		if(handler != NULL) {
+			handler(object, num_objects, context);
+			
+		}
+		
+		num_objects = num_objects + 1;
+		
+		skip_whitespace(reader);
 		// Read in a character and advance the stream position indicator
-		token = get_char(fpointer);
+		token = get_char(reader);
 
 		if(token == '{') {
-			ungetc(token, fpointer);
+			unget_char(reader, token);
 			
 		}
 
 		if(token == ',') {
-			skip_whitespace(fpointer);
+			skip_whitespace(reader);
 			// Read in a character and advance the stream position indicator
-			token = get_char(fpointer);
+			token = get_char(reader);
 			
 			if(token == '{') {
-				ungetc(token, fpointer);
+				unget_char(reader, token);
 				
 			}				
 			
 		}			
-		// Increment array index counter
-		index = index + 1;
 	
 	} // EO While Loop
 
 	// Return the total number of objects read-in from the scene
-	return index;
+	return num_objects;
+
+}
 
-}
\ No newline at end of file
+
+/**
+ * json_read_scene
+ *
+ * @param file pointer
+ * @param scene - Scene the objects are appended to, there is no limit on the number of objects
+ * @returns integer number of item read-in
+ * @description reads in a scene of objects formatted using JavaScript Object Notation (JSON) from
+ * a file stream one character at a time
+ */
+int json_read_scene(FILE *fpointer, Scene *scene) {
+	JsonReader reader;
+
+	reader.fpointer = fpointer;
+	reader.data = NULL;
+	reader.length = 0;
+	reader.offset = 0;
+	reader.line_num = 0;
+
+	return parse_scene(&reader, scene, NULL, NULL, NULL);
+
+}
+
+
+/**
+ * reader_map
+ *
+ * @param reader - reader to set up
+ * @param filename - path of the json scene file
+ * @returns void
+ * @description maps the whole scene file into memory for parsing in place. An empty file is not
+ * mapped, the parser then reports the end-of-file like it does for a stream.
+ */
+static void reader_map(JsonReader *reader, const char *filename) {
+	struct stat status;
+	void *data;
+	int descriptor;
+
+	descriptor = open(filename, O_RDONLY);
+
+	if((descriptor < 0) || (fstat(descriptor, &status) != 0)) {
+		fprintf(stderr, "Error, could not open file.\n");
+		exit(-1);
+
+	}
+
+	reader->fpointer = NULL;
+	reader->data = NULL;
+	reader->length = 0;
+	reader->offset = 0;
+	reader->line_num = 0;
+
+	if(status.st_size > 0) {
+		data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+
+		if(data == MAP_FAILED) {
+			fprintf(stderr, "Error, could not map file.\n");
+			close(descriptor);
+			exit(-1);
+
+		}
+
+		madvise(data, (size_t)status.st_size, MADV_SEQUENTIAL);
+		reader->data = data;
+		reader->length = (size_t)status.st_size;
+
+	}
+
+	// The mapping stays valid after the descriptor is closed
+	close(descriptor);
+
+}
+
+
+/**
+ * json_read_scene_mmap
+ *
+ * @param filename - path of the json scene file
+ * @param scene - Scene the objects are appended to, there is no limit on the number of objects
+ * @returns integer number of item read-in
+ * @description reads in the same scenes as json_read_scene, with the same error messages, but maps
+ * the whole file into memory and parses it in place. No per character library calls are made,
+ * whitespace is skipped with a tight loop, and numbers are converted by parse_double. The mapping
+ * is released before returning.
+ */
+int json_read_scene_mmap(const char *filename, Scene *scene) {
+	JsonReader reader;
+	int num_objects;
+
+	reader_map(&reader, filename);
+	num_objects = parse_scene(&reader, scene, NULL, NULL, NULL);
+	reader_close(&reader);
+
+	return num_objects;
+
+}
+
+
+/**
+ * json_stream_scene
+ *
+ * @param file pointer
+ * @param handler - called with each object as soon as its closing brace is read
+ * @param context - passed through to the handler
+ * @returns integer number of item read-in
+ * @description streaming counterpart of json_read_scene. Objects are not collected, each one is
+ * handed to the handler and its storage is reused for the next object, so the parser's memory
+ * does not grow with the size of the scene. The object and its type string are only valid for
+ * the duration of the call.
+ */
+int json_stream_scene(FILE *fpointer, ObjectHandler handler, void *context) {
+	JsonReader reader;
+
+	reader.fpointer = fpointer;
+	reader.data = NULL;
+	reader.length = 0;
+	reader.offset = 0;
+	reader.line_num = 0;
+
+	return parse_scene(&reader, NULL, handler, context, NULL);
+
+}
+
+
+/**
+ * json_stream_scene_mmap
+ *
+ * @param filename - path of the json scene file
+ * @param handler - called with each object as soon as its closing brace is read
+ * @param context - passed through to the handler
+ * @returns integer number of item read-in
+ * @description streams the objects of a memory mapped scene file, see json_stream_scene
+ */
+int json_stream_scene_mmap(const char *filename, ObjectHandler handler, void *context) {
+	JsonReader reader;
+	int num_objects;
+
+	reader_map(&reader, filename);
+	num_objects = parse_scene(&reader, NULL, handler, context, NULL);
+	reader_close(&reader);
+
+	return num_objects;
+
+}
+
+
+/**
+ * MotionStream
+ *
+ * @description a motion file being streamed, the keyframe storage and the consumer it is handed to
+ */
+typedef struct MotionStream {
+	MotionKey key;
+	MotionHandler handler;
+	void *context;
+
+} MotionStream;
+
+
+/**
+ * motion_object
+ *
+ * @param object - object of the keyframe just read in, stored in the stream's keyframe
+ * @param index - position of the keyframe in the motion file
+ * @param context - MotionStream
+ * @returns void
+ * @description ObjectHandler that hands the whole keyframe on to the motion handler
+ */
+static void motion_object(Object *object, int index, void *context) {
+	MotionStream *stream = (MotionStream *)context;
+
+	stream->handler(&stream->key, index, stream->context);
+
+}
+
+
+/**
+ * json_stream_motion
+ *
+ * @param file pointer
+ * @param handler - called with each keyframe as soon as its closing brace is read
+ * @param context - passed through to the handler
+ * @returns integer number of keyframes read-in
+ * @description reads a motion file, a json array of keyframes. Keyframes are written like scene
+ * objects and may also give the "frame" they apply to and the "object" of the scene they move,
+ * keys that a scene file rejects. Keyframes are streamed like json_stream_scene streams objects.
+ */
+int json_stream_motion(FILE *fpointer, MotionHandler handler, void *context) {
+	JsonReader reader;
+	MotionStream stream;
+
+	reader.fpointer = fpointer;
+	reader.data = NULL;
+	reader.length = 0;
+	reader.offset = 0;
+	reader.line_num = 0;
+
+	stream.handler = handler;
+	stream.context = context;
+
+	return parse_scene(&reader, NULL, motion_object, &stream, &stream.key);
+
+}
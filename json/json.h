@@ -13,11 +13,13 @@
  * Camera
  *
  * @description stores values for height and width properties of an camera
- * object
+ * object, and the position a camera keyframe of a motion file moves the camera to. A scene's
+ * camera sits at the origin, the position of its camera object is read and ignored.
  */
 typedef struct Camera {
 	double width;
 	double height;
+	double position[3];
 	
 } Camera;
 
@@ -71,7 +73,67 @@ typedef struct Object {
 
 } Object;
 
+
+// Objects per storage block of a Scene
+#define SCENE_BLOCK_OBJECTS 4096
+
+/**
+ * Scene
+ *
+ * @description growable collection of objects read in by the json parser. Objects live in fixed
+ * size blocks carved out of the scene's arena, so appending never moves an existing object and
+ * memory grows linearly with the object count. Type strings are stored in the same arena and
+ * scene_release is the single point where all of it is freed.
+ */
+typedef struct Scene {
+	Arena arena;
+	Object **blocks;
+	int num_blocks;
+	int max_blocks;
+	int num_objects;
+
+} Scene;
+
+/**
+ * ObjectHandler
+ *
+ * @description consumer of a streamed scene, called with each object and its index in the scene
+ * as soon as the object's closing brace has been read
+ */
+typedef void (*ObjectHandler)(Object *object, int index, void *context);
+
+
+/**
+ * MotionKey
+ *
+ * @description one keyframe read in from a motion file. object holds the keyframe's type and
+ * position, frame is the frame it applies to and target the index of the scene object it moves,
+ * -1 when no object is named. Only motion files have the frame and object keys.
+ */
+typedef struct MotionKey {
+	Object object;
+	int frame;
+	int target;
+
+} MotionKey;
+
+/**
+ * MotionHandler
+ *
+ * @description consumer of a streamed motion file, called with each keyframe and its index in the
+ * file as soon as the keyframe's closing brace has been read
+ */
+typedef void (*MotionHandler)(MotionKey *key, int index, void *context);
+
 // function declarations
-int json_read_scene(FILE *fpointer, Object objects[]);
+void scene_init(Scene *scene);
+Object *scene_append(Scene *scene);
+Object *scene_object(Scene *scene, int index);
+void scene_release(Scene *scene);
+int json_read_scene(FILE *fpointer, Scene *scene);
+int json_read_scene_mmap(const char *filename, Scene *scene);
+int json_stream_scene(FILE *fpointer, ObjectHandler handler, void *context);
+int json_stream_scene_mmap(const char *filename, ObjectHandler handler, void *context);
+int json_stream_motion(FILE *fpointer, MotionHandler handler, void *context);
  
 #endif
\ No newline at end of file
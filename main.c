@@ -11,14 +11,136 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include "arena\arena.h"
 #include "json\json.h"
 #include "ppm\ppm.h"
+#include "scene\scene.h"
+#include "simd\simd.h"
+#include "threadpool\threadpool.h"
+#include "bvh\bvh.h"
+#include "tilebin\tilebin.h"
+#include "binscene\binscene.h"
+#include "stats\stats.h"
 #include "raycaster\raycaster.h"
+#include "animation\animation.h"
+#include "server\server.h"
+#include "batch\batch.h"
 
-// Allocate object array, specifications do not support more then 128 objects in a scene
-Object objects[128];
 int maximum_color;
 
+/**
+ * print_object
+ *
+ * @param object - object read in from the json parser
+ * @returns void
+ * @description displays a json object read in, valid for camera, sphere, and plane
+ */
+static void print_object(Object *object) {
+	// Account for empty object data
+	if((object->type) == NULL){
+		printf("Type: Empty Object\n");
+		printf("No properties discovered\n\n");
+		
+	} else {
+		if(strcmp(object->type, "camera") == 0){
+			printf("Type: %s\n", object->type);
+			printf("Width: %lf\n", object->properties.camera.width);
+			printf("Height: %lf\n\n", object->properties.camera.height);
+		}
+		
+		if(strcmp(object->type, "sphere") == 0){
+			printf("Type: %s\n", object->type);
+			printf("Radius: %lf\n", object->properties.sphere.radius);
+			printf("Color: %lf %lf %lf\n", object->properties.sphere.color[0], object->properties.sphere.color[1], object->properties.sphere.color[2]);
+			printf("Position: %lf %lf %lf\n\n", object->properties.sphere.position[0], object->properties.sphere.position[1], object->properties.sphere.position[2]);
+			
+		}
+		
+		if(strcmp(object->type, "plane") == 0){
+			printf("Type: %s\n", object->type);
+			printf("Color: %lf %lf %lf\n", object->properties.plane.color[0], object->properties.plane.color[1], object->properties.plane.color[2]);
+			printf("Position: %lf %lf %lf\n", object->properties.plane.position[0], object->properties.plane.position[1], object->properties.plane.position[2]);
+			printf("Normal: %lf %lf %lf\n\n", object->properties.plane.normal[0], object->properties.plane.normal[1], object->properties.plane.normal[2]);			
+		
+		}
+		
+	}
+	
+}
+
+
+/**
+ * list_objects
+ *
+ * @param num_objects - number of objects of a collected scene, -1 for a streamed scene
+ * @returns void
+ * @description ListHandler passed to scene_load, heads the objects displayed next with their
+ * number, a streamed scene's number is only known once its objects are displayed
+ */
+static void list_objects(int num_objects) {
+	if(num_objects < 0) {
+		printf("\n- STREAMING OBJECTS -\n\n");
+		
+	} else if(num_objects > 0) {
+		printf("\n- NUMBER OF OBJECTS: %d -\n\n", num_objects);
+		
+	}
+	
+}
+
+
+/**
+ * display_object
+ *
+ * @param object - object read in from the json parser, only valid during the call
+ * @param index - position of the object in the scene
+ * @param context - unused
+ * @returns void
+ * @description ObjectHandler passed to scene_load, displays each object of a json scene as it is
+ * read in, or once the scene is read when the objects are collected first
+ */
+static void display_object(Object *object, int index, void *context) {
+	print_object(object);
+	
+}
+
+
+/**
+ * count_differences
+ *
+ * @param first - rendered image
+ * @param second - image of the same size rendered another way
+ * @param largest - receives the largest difference of a single color channel
+ * @returns number of pixels whose color differs
+ * @description compares two renders of the same scene pixel by pixel
+ */
+static int count_differences(Image *first, Image *second, int *largest) {
+	Pixel *a, *b;
+	int index, count, difference;
+	
+	count = 0;
+	*largest = 0;
+	
+	for(index = 0; index < first->width * first->height; index++) {
+		a = &first->image_data[index];
+		b = &second->image_data[index];
+		
+		if((a->red != b->red) || (a->green != b->green) || (a->blue != b->blue)) {
+			count = count + 1;
+			difference = abs(a->red - b->red);
+			difference = (abs(a->green - b->green) > difference) ? abs(a->green - b->green) : difference;
+			difference = (abs(a->blue - b->blue) > difference) ? abs(a->blue - b->blue) : difference;
+			*largest = (difference > *largest) ? difference : *largest;
+			
+		}
+		
+	}
+	
+	return count;
+	
+}
+
+
 /**
  * main
  *
@@ -28,9 +150,21 @@ int maximum_color;
  * @description main function called by the operating system when the user runs the program. 
  */
 int main(int argc, char *argv[]){
-	FILE *fpointer;
 	int num_objects, count, index;
-	Image *ppm_image;
+	int num_arguments, num_threads;
+	SimdLevel simd_level;
+	int use_bvh, use_bins, mmap_scene, stream_scene, convert, stream_output, mmap_output, p3_output, print_stats;
+	int single_precision, validate_single, compact, differences, largest, num_frames, deadline, finest, samples;
+	char *motion, *socket_path, *manifest;
+	ServerOptions server_options;
+	SceneOptions scene_options;
+	Animation *animation;
+	ThreadPool *pool;
+	char *arguments[4], *input;
+	Image *ppm_image, single_image;
+	RenderScene *render_scene;
+	PpmStream *stream;
+	PpmMap *map;
 	maximum_color = 255;
 	
 	// Allocate memory for Image
@@ -41,16 +175,253 @@ int main(int argc, char *argv[]){
 		
 	}
 	
+	// Separate options from the positional width, height, input, and output arguments
+	num_arguments = 0;
+	num_threads = 1;
+	simd_level = SIMD_AVX512;
+	use_bvh = 1;
+	use_bins = 0;
+	mmap_scene = 0;
+	stream_scene = 0;
+	convert = 0;
+	stream_output = 0;
+	mmap_output = 0;
+	p3_output = 0;
+	print_stats = 0;
+	single_precision = 0;
+	validate_single = 0;
+	compact = 0;
+	motion = NULL;
+	num_frames = 0;
+	socket_path = NULL;
+	manifest = NULL;
+	deadline = 0;
+	samples = 0;
+	
+	for(index = 1; index < argc; index++) {
+		if(strcmp(argv[index], "--threads") == 0) {
+			// Thread count, 0 selects one thread per online processor
+			if((index + 1 >= argc) || (strspn(argv[index + 1], "0123456789") != strlen(argv[index + 1])) || (strlen(argv[index + 1]) == 0)) {
+				fprintf(stderr, "Error, --threads expects a non-negative integer.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			num_threads = atoi(argv[index]);
+			
+			if(num_threads == 0) {
+				num_threads = threadpool_default_threads();
+				
+			}
+			
+		} else if(strcmp(argv[index], "--simd") == 0) {
+			// Widest packet kernel instruction set allowed, clamped to what the processor supports
+			if((index + 1 >= argc) || (simd_parse_level(argv[index + 1], &simd_level) == 0)) {
+				fprintf(stderr, "Error, --simd expects one of scalar, sse2, avx2, or avx512.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			
+		} else if(strcmp(argv[index], "--no-bvh") == 0) {
+			// Scan every sphere for every pixel
+			use_bvh = 0;
+			
+		} else if(strcmp(argv[index], "--bin") == 0) {
+			// Test each tile's rays against the spheres binned into that tile instead of the hierarchy
+			use_bins = 1;
+			
+		} else if(strcmp(argv[index], "--mmap-scene") == 0) {
+			// Map the scene file into memory and parse it in place
+			mmap_scene = 1;
+			
+		} else if(strcmp(argv[index], "--stream-scene") == 0) {
+			// Build the render scene while the json scene is parsed
+			stream_scene = 1;
+			
+		} else if(strcmp(argv[index], "--convert") == 0) {
+			// Write the scene out as a binary scene file instead of rendering it
+			convert = 1;
+			
+		} else if(strcmp(argv[index], "--stream-output") == 0) {
+			// Write the image out band by band while it is rendered
+			stream_output = 1;
+			
+		} else if(strcmp(argv[index], "--mmap-output") == 0) {
+			// Render straight into the memory mapped output file
+			mmap_output = 1;
+			
+		} else if(strcmp(argv[index], "--p3") == 0) {
+			// Write an ASCII ppm3 image, always from a whole image buffer
+			p3_output = 1;
+			
+		} else if(strcmp(argv[index], "--float") == 0) {
+			// Intersect in single precision, the double precision geometry is released
+			single_precision = 1;
+			
+		} else if(strcmp(argv[index], "--validate-float") == 0) {
+			// Render in double and single precision, report the pixels that differ
+			validate_single = 1;
+			
+		} else if(strcmp(argv[index], "--compact") == 0) {
+			// Spheres as single precision centers and radii with palette colors, streamed in
+			compact = 1;
+			stream_scene = 1;
+			single_precision = 1;
+			
+		} else if(strcmp(argv[index], "--animate") == 0) {
+			// Render a numbered frame sequence moved by the keyframes of a motion file
+			if(index + 1 >= argc) {
+				fprintf(stderr, "Error, --animate expects a motion file.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			motion = argv[index];
+			
+		} else if(strcmp(argv[index], "--frames") == 0) {
+			// Number of frames to animate, 0 animates up to the last keyframe
+			if((index + 1 >= argc) || (strspn(argv[index + 1], "0123456789") != strlen(argv[index + 1])) || (strlen(argv[index + 1]) == 0)) {
+				fprintf(stderr, "Error, --frames expects a non-negative integer.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			num_frames = atoi(argv[index]);
+			
+		} else if(strcmp(argv[index], "--serve") == 0) {
+			// Run as a render server taking jobs on a Unix domain socket
+			if(index + 1 >= argc) {
+				fprintf(stderr, "Error, --serve expects a socket path.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			socket_path = argv[index];
+			
+		} else if(strcmp(argv[index], "--deadline") == 0) {
+			// Render coarse to fine and stop refining after the given number of milliseconds
+			if((index + 1 >= argc) || (strspn(argv[index + 1], "0123456789") != strlen(argv[index + 1])) || (strlen(argv[index + 1]) == 0)) {
+				fprintf(stderr, "Error, --deadline expects a non-negative number of milliseconds.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			deadline = atoi(argv[index]);
+			
+		} else if(strcmp(argv[index], "--aa") == 0) {
+			// Antialias edges with n x n rays per edge pixel
+			if((index + 1 >= argc) || (strspn(argv[index + 1], "0123456789") != strlen(argv[index + 1])) || (strlen(argv[index + 1]) == 0) ||
+				(atoi(argv[index + 1]) < 2) || (atoi(argv[index + 1]) > ANTIALIAS_MAX_SAMPLES)) {
+				fprintf(stderr, "Error, --aa expects a number of samples per axis from 2 to %d.\n", ANTIALIAS_MAX_SAMPLES);
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			samples = atoi(argv[index]);
+			
+		} else if(strcmp(argv[index], "--batch") == 0) {
+			// Render every job of a manifest file in one process
+			if(index + 1 >= argc) {
+				fprintf(stderr, "Error, --batch expects a manifest file.\n");
+				exit(-1);
+				
+			}
+			
+			index = index + 1;
+			manifest = argv[index];
+			
+		} else if(strcmp(argv[index], "--stats") == 0) {
+			// Count rays and intersection tests, time each phase, print a json summary to stderr
+			print_stats = 1;
+			
+		} else if(num_arguments < 4) {
+			arguments[num_arguments] = argv[index];
+			num_arguments = num_arguments + 1;
+			
+		} else {
+			num_arguments = num_arguments + 1;
+			
+		}
+		
+	}
+	
+	if((compact) && ((convert) || (validate_single) || (motion != NULL))) {
+		fprintf(stderr, "Error, --compact cannot be combined with --convert, --validate-float, or --animate.\n");
+		exit(-1);
+		
+	}
+	
+	// How scene files are read and readied, the same for a single render, the server, and a batch. Tile bins
+	// replace the hierarchy, except in a binary scene file. Validation and animation need the double
+	// precision columns, and a binary scene file stores them.
+	scene_options.use_bvh = (use_bvh) && ((use_bins == 0) || (convert));
+	scene_options.single_precision = (single_precision) && (validate_single == 0) && (convert == 0) && (motion == NULL);
+	scene_options.compact = compact;
+	scene_options.mmap_scene = mmap_scene;
+	scene_options.stream_scene = stream_scene;
+	scene_options.list = NULL;
+	scene_options.display = NULL;
+	
+	if((socket_path != NULL) && (num_arguments == 0)) {
+		// Every job names its own size, scene, and image, the options apply to all of them. The
+		// server always maps its scene files.
+		server_options.num_threads = num_threads;
+		server_options.simd_level = simd_level;
+		server_options.use_bins = use_bins;
+		server_options.scene = scene_options;
+		server_options.scene.mmap_scene = 1;
+		server_run(socket_path, &server_options);
+		free(ppm_image);
+		return(0);
+		
+	}
+	
+	if((manifest != NULL) && (num_arguments == 0)) {
+		// Every job names its own size, scene, and image, the options apply to all of them. A batch
+		// always maps its scene files.
+		if(print_stats) {
+			stats_enable();
+			
+		}
+		
+		simd_select(simd_level);
+		pool = (num_threads > 1) ? threadpool_create(num_threads) : NULL;
+		scene_options.mmap_scene = 1;
+		count = batch_render(manifest, pool, &scene_options, use_bins, p3_output);
+		printf("\n- BATCH: %d IMAGES WRITTEN -\n", count);
+		
+		if(pool != NULL) {
+			threadpool_destroy(pool);
+			
+		}
+		
+		free(ppm_image);
+		return(0);
+		
+	}
+	
 	// Validate command line input(s)
-	if(argc != 5){
-		fprintf(stderr, "Error, incorrect usage!\nCorrect usage pattern is: raycast width height input.json output.ppm.\n");
+	if(num_arguments != (convert ? 2 : 4)){
+		fprintf(stderr, "Error, incorrect usage!\nCorrect usage pattern is: raycast [--threads n] [--simd level] [--no-bvh] [--bin] [--mmap-scene] [--stream-scene] [--stream-output] [--mmap-output] [--p3] [--float] [--validate-float] [--compact] [--deadline ms] [--aa n] [--stats] width height input.json output.ppm.\n");
+		fprintf(stderr, "To render an animation: raycast [options] --animate motion.json [--frames n] width height input.json output.ppm.\n");
+		fprintf(stderr, "To render a manifest of jobs: raycast [--threads n] [--simd level] [--no-bvh] [--bin] [--stream-scene] [--p3] [--float] [--compact] [--stats] --batch manifest.txt.\n");
+		fprintf(stderr, "To serve render jobs: raycast [--threads n] [--simd level] [--no-bvh] [--bin] [--stream-scene] [--float] [--compact] --serve socket_path.\n");
+		fprintf(stderr, "To convert a scene: raycast [--threads n] [--no-bvh] [--mmap-scene] [--stream-scene] [--stats] --convert input.json output.rscn.\n");
 		exit(-1);
 		
-	} else {
+	} else if(convert == 0) {
 		// Loop through the first two inputs to check if they are integers
-		for(index = 1; index < 3; index++){
-			for(count = 0; count < strlen(argv[index]); count++) {
-				if((!(isdigit((argv[index])[count]))) && (((argv[index])[count]) != '.')){
+		for(index = 0; index < 2; index++){
+			for(count = 0; count < strlen(arguments[index]); count++) {
+				if((!(isdigit((arguments[index])[count]))) && (((arguments[index])[count]) != '.')){
 					fprintf(stderr, "Error, incorrect width and/or height value(s).\n");
 					exit(-1);
 					
@@ -62,73 +433,212 @@ int main(int argc, char *argv[]){
 		
 	}
 
-	// Open json file for reading
-	fpointer = fopen(argv[3], "r");
+	if(print_stats) {
+		stats_enable();
 		
-	if(fpointer == NULL) {
-		fprintf(stderr, "Error, could not open file.\n");
-		// Close file stream flush all buffers
-		fclose(fpointer);
-		exit(-1);
-		
-	} else {
+	}
+	
+	// Json or binary scene file to read
+	input = convert ? arguments[0] : arguments[2];
+	
+	if(convert == 0) {
 		// Set Image properties
-		ppm_image->width = atoi(argv[1]);
-		ppm_image->height = atoi(argv[2]);
+		ppm_image->width = atoi(arguments[0]);
+		ppm_image->height = atoi(arguments[1]);
 		ppm_image->max_color = maximum_color;
 		
-		// Allocate memory size for image data
-		ppm_image->image_data = malloc(sizeof(Pixel) * ppm_image->width * ppm_image->height);
+		// Allocate memory size for image data, a streamed image only holds a few bands and a
+		// mapped image lives in the output file
+		ppm_image->image_data = ((stream_output || mmap_output) && (p3_output == 0) && (validate_single == 0) && (motion == NULL) && (deadline == 0) && (samples == 0)) ? NULL : malloc(sizeof(Pixel) * ppm_image->width * ppm_image->height);
 		
-		// Read in json scene return number of objects
-		num_objects = json_read_scene(fpointer, objects);
+	}
+	
+	// Install the widest supported intersection kernels
+	simd_select(simd_level);
+	
+	// Render threads, the calling thread renders alone when one thread is requested
+	pool = (num_threads > 1) ? threadpool_create(num_threads) : NULL;
+	
+	// Read the scene and ready it for rendering, displaying its objects as they are read
+	scene_options.list = list_objects;
+	scene_options.display = display_object;
+	render_scene = scene_load(input, &scene_options, pool, &num_objects);
+	
+	if(render_scene->mapping != NULL) {
+		printf("\n- BINARY SCENE: %d OBJECTS, %d SPHERES, %d PLANES -\n", num_objects, render_scene->num_spheres, render_scene->num_planes);
+		
+	} else if((stream_scene) && (num_objects > 0)) {
+		printf("- NUMBER OF OBJECTS: %d -\n", num_objects);
+		
+	}
+	
+	if((render_scene->compact) && (num_objects > 0)) {
+		printf("- COMPACT SCENE: %d SPHERES, %d COLORS -\n", render_scene->num_spheres, render_scene->num_colors);
+		
+	}
+	
+	if((num_objects <= 0) && (convert == 0)) {
+		// Empty Scene
+		
+	} else {
 		
-		if(num_objects <= 0) {
-			// Empty Scene
+		if((use_bins) && (convert == 0)) {
+			// Bin the spheres into the screen tiles their projections cover, after the single
+			// precision geometry is built since the bins gather the geometry the kernels test
+			stats_start(PHASE_BVH);
+			render_scene->bins = tilebin_build(render_scene, ppm_image->width, ppm_image->height, TILE_SIZE);
+			stats_stop(PHASE_BVH);
+			printf("\n- TILE BINS: %d CANDIDATES IN %d TILES -\n", render_scene->bins->num_entries, render_scene->bins->tiles_x * render_scene->bins->tiles_y);
 			
-		} else {
+		}
+		
+		if(convert) {
+			// Store the render scene, with its hierarchy, as a binary scene file
+			stats_start(PHASE_WRITE);
+			binscene_write(arguments[1], render_scene, num_objects);
+			stats_stop(PHASE_WRITE);
+			
+		} else if(motion != NULL) {
+			// Render every frame into the same image, the scene and its hierarchy are reused
+			animation = animation_load(motion, render_scene, num_objects, num_frames);
+			printf("\n- ANIMATING %d FRAMES, %d TRACKS -\n", animation->num_frames, animation->num_tracks);
+			animation_render(animation, render_scene, ppm_image, pool, arguments[3], p3_output, single_precision);
+			animation_free(animation);
+			
+		} else if(validate_single) {
+			// Raycast scene in double then single precision, write out the double precision image
+			stats_start(PHASE_RENDER);
+			raycaster(render_scene, ppm_image, pool);
+			
+			single_image = *ppm_image;
+			single_image.image_data = malloc(sizeof(Pixel) * ppm_image->width * ppm_image->height);
 			
-			// Display json objects read in, valid for camera, sphere, and plane
-			printf("\n- NUMBER OF OBJECTS: %d -\n\n", num_objects);
-			for(count = 0; count < num_objects; count++) {
+			if(single_image.image_data == NULL) {
+				fprintf(stderr, "Failed to allocate memory.\n");
+				exit(-1);
 				
-				// Account for empty object data
-				if((objects[count].type) == NULL){
-					printf("Type: Empty Object\n");
-					printf("No properties discovered\n\n");
-					
-				} else {
-					if(strcmp(objects[count].type, "camera") == 0){
-						printf("Type: %s\n", objects[count].type);
-						printf("Width: %lf\n", objects[count].properties.camera.width);
-						printf("Height: %lf\n\n", objects[count].properties.camera.height);
-					}
-					
-					if(strcmp(objects[count].type, "sphere") == 0){
-						printf("Type: %s\n", objects[count].type);
-						printf("Radius: %lf\n", objects[count].properties.sphere.radius);
-						printf("Color: %lf %lf %lf\n", objects[count].properties.sphere.color[0], objects[count].properties.sphere.color[1], objects[count].properties.sphere.color[2]);
-						printf("Position: %lf %lf %lf\n\n", objects[count].properties.sphere.position[0], objects[count].properties.sphere.position[1], objects[count].properties.sphere.position[2]);
-						
-					}
-					
-					if(strcmp(objects[count].type, "plane") == 0){
-						printf("Type: %s\n", objects[count].type);
-						printf("Color: %lf %lf %lf\n", objects[count].properties.plane.color[0], objects[count].properties.plane.color[1], objects[count].properties.plane.color[2]);
-						printf("Position: %lf %lf %lf\n", objects[count].properties.plane.position[0], objects[count].properties.plane.position[1], objects[count].properties.plane.position[2]);
-						printf("Normal: %lf %lf %lf\n\n", objects[count].properties.plane.normal[0], objects[count].properties.plane.normal[1], objects[count].properties.plane.normal[2]);			
-					
-					}
-					
-				}
+			}
+			
+			scene_single(render_scene, 0);
+			
+			if(render_scene->bins != NULL) {
+				// The bins gather the geometry the kernels test, single precision from here
+				tilebin_free(render_scene->bins);
+				render_scene->bins = tilebin_build(render_scene, ppm_image->width, ppm_image->height, TILE_SIZE);
+				
+			}
+			
+			raycaster(render_scene, &single_image, pool);
+			scene_double(render_scene);
+			stats_stop(PHASE_RENDER);
+			
+			differences = count_differences(ppm_image, &single_image, &largest);
+			printf("\n- FLOAT VALIDATION: %d OF %d PIXELS DIFFER (%.4f%%), LARGEST CHANNEL DIFFERENCE %d -\n", differences,
+				ppm_image->width * ppm_image->height, 100.0 * differences / ((double)ppm_image->width * ppm_image->height), largest);
+			free(single_image.image_data);
+			
+			stats_start(PHASE_WRITE);
+			
+			if(p3_output) {
+				write_p3_image_parallel(arguments[3], ppm_image, pool);
+				
+			} else {
+				write_p6_image(arguments[3], ppm_image);
+				
+			}
+			
+			stats_stop(PHASE_WRITE);
+			
+		} else if(deadline > 0) {
+			// Raycast scene coarse to fine, write out the finest image reached by the deadline
+			stats_start(PHASE_RENDER);
+			finest = raycaster_progressive(render_scene, ppm_image, pool, deadline);
+			stats_stop(PHASE_RENDER);
+			printf("\n- PROGRESSIVE: %dx%d PIXEL BLOCKS -\n", finest, finest);
+			stats_start(PHASE_WRITE);
+			
+			if(p3_output) {
+				write_p3_image_parallel(arguments[3], ppm_image, pool);
+				
+			} else {
+				write_p6_image(arguments[3], ppm_image);
+				
+			}
+			
+			stats_stop(PHASE_WRITE);
+			
+		} else if(samples > 0) {
+			// Raycast scene, then supersample the pixels on object edges
+			stats_start(PHASE_RENDER);
+			count = raycaster_antialias(render_scene, ppm_image, pool, samples);
+			stats_stop(PHASE_RENDER);
+			printf("\n- ANTIALIASING: %d OF %d PIXELS SUPERSAMPLED (%.2f%%) -\n", count, ppm_image->width * ppm_image->height,
+				100.0 * count / ((double)ppm_image->width * ppm_image->height));
+			stats_start(PHASE_WRITE);
+			
+			if(p3_output) {
+				write_p3_image_parallel(arguments[3], ppm_image, pool);
+				
+			} else {
+				write_p6_image(arguments[3], ppm_image);
 				
 			}
+			
+			stats_stop(PHASE_WRITE);
+			
+		} else if(p3_output) {
+			// Raycast scene, write out to ppm3 image formatting rows on the render threads
+			stats_start(PHASE_RENDER);
+			raycaster(render_scene, ppm_image, pool);
+			stats_stop(PHASE_RENDER);
+			stats_start(PHASE_WRITE);
+			write_p3_image_parallel(arguments[3], ppm_image, pool);
+			stats_stop(PHASE_WRITE);
+			
+		} else if(mmap_output) {
+			// Raycast scene into the mapped ppm6 image, there is nothing left to write
+			stats_start(PHASE_WRITE);
+			map = ppm_map_open(arguments[3], ppm_image);
+			stats_stop(PHASE_WRITE);
+			stats_start(PHASE_RENDER);
+			raycaster(render_scene, ppm_image, pool);
+			stats_stop(PHASE_RENDER);
+			stats_start(PHASE_WRITE);
+			ppm_map_close(map);
+			stats_stop(PHASE_WRITE);
+			
+		} else if(stream_output) {
+			// Raycast scene band by band, a writer thread writes finished bands to the ppm6 image
+			stream = ppm_stream_open(arguments[3], ppm_image, BAND_ROWS, BAND_BUFFERS);
+			stats_start(PHASE_RENDER);
+			raycaster_stream(render_scene, ppm_image, pool, stream);
+			stats_stop(PHASE_RENDER);
+			stats_start(PHASE_WRITE);
+			ppm_stream_close(stream);
+			stats_stop(PHASE_WRITE);
+			
+		} else {
 			// Raycast scene, write out to ppm6 image
-			write_p6_image(argv[4], raycaster(objects, ppm_image, num_objects));
+			stats_start(PHASE_RENDER);
+			raycaster(render_scene, ppm_image, pool);
+			stats_stop(PHASE_RENDER);
+			stats_start(PHASE_WRITE);
+			write_p6_image(arguments[3], ppm_image);
+			stats_stop(PHASE_WRITE);
 			
 		}
 		
+		stats_print(stderr, num_objects, render_scene->num_spheres, render_scene->num_planes, num_threads);
+		
 	}
+	
+	scene_free(render_scene);
+	
+	if(pool != NULL) {
+		threadpool_destroy(pool);
+		
+	}
+	
 
 	return(0);
 	
@@ -0,0 +1,559 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: microbench.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "..\ppm\ppm.h"
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\scene\scene.h"
+#include "..\simd\simd.h"
+#include "..\threadpool\threadpool.h"
+#include "..\raycaster\raycaster.h"
+#include "microbench.h"
+
+/**
+ * KernelPass
+ *
+ * @description runs every test of a set passes times through one kernel, returns a sum of the
+ * results so the work cannot be optimized away
+ */
+typedef double (*KernelPass)(TestSet *set, int passes);
+
+// Results of the timed passes end up here so the compiler must compute them
+volatile double microbench_sink;
+
+/**
+ * microbench_random
+ *
+ * @param state - generator state, never 0
+ * @returns a pseudo random number in [0, 1)
+ * @description xorshift generator, the same seed gives the same test sets on every platform
+ */
+static double microbench_random(unsigned int *state) {
+	unsigned int x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return((x >> 8) / 16777216.0);
+
+}
+
+
+/**
+ * random_unit
+ *
+ * @param state - generator state
+ * @param v - receives a random unit vector
+ * @returns void
+ * @description picks points in the unit ball until one is far enough from the center to be
+ * normalized, every direction is equally likely
+ */
+static void random_unit(unsigned int *state, double *v) {
+	double len;
+
+	do {
+		v[0] = 2.0 * microbench_random(state) - 1.0;
+		v[1] = 2.0 * microbench_random(state) - 1.0;
+		v[2] = 2.0 * microbench_random(state) - 1.0;
+		len = sqr(v[0]) + sqr(v[1]) + sqr(v[2]);
+
+	} while((len > 1.0) || (len < 0.01));
+
+	normalize(v);
+
+}
+
+
+/**
+ * microbench_case_name
+ *
+ * @param hit_case - share of hits in a test set
+ * @returns the name of the case
+ * @description names a case for the report
+ */
+const char *microbench_case_name(HitCase hit_case) {
+	if(hit_case == CASE_HALF) {
+		return("half");
+
+	} else if(hit_case == CASE_HIT) {
+		return("hit");
+
+	} else if(hit_case == CASE_GRAZING) {
+		return("grazing");
+
+	}
+
+	return("miss");
+
+}
+
+
+/**
+ * generate_set
+ *
+ * @param set - test set to fill in
+ * @param spheres - 1 generates spheres, 0 planes
+ * @param hit_case - share of the tests that hit
+ * @param state - generator state
+ * @returns void
+ * @description places every primitive relative to its ray. A sphere sits 5 to 20 units down the
+ * ray, moved sideways by a multiple of its radius, under 1 hits and over 1 misses. A plane that
+ * hits faces the ray 5 to 20 units ahead, a plane that misses lies behind the ray, and a grazing
+ * plane runs almost parallel to the ray one unit to its side.
+ */
+static void generate_set(TestSet *set, int spheres, HitCase hit_case, unsigned int *state) {
+	double side[3], distance, offset, dot;
+	double *ro, *rd, *position, *normal;
+	int index, ray, hit, axis;
+
+	for(ray = 0; ray < MICROBENCH_TESTS / SIMD_BATCH; ray++) {
+		for(axis = 0; axis < 3; axis++) {
+			set->ro[ray][axis] = 2.0 * microbench_random(state) - 1.0;
+
+		}
+
+		random_unit(state, set->rd[ray]);
+
+	}
+
+	for(index = 0; index < MICROBENCH_TESTS; index++) {
+		ro = set->ro[index / SIMD_BATCH];
+		rd = set->rd[index / SIMD_BATCH];
+		position = set->position[index];
+		normal = set->normal[index];
+
+		if(hit_case == CASE_HALF) {
+			hit = (microbench_random(state) < 0.5);
+
+		} else {
+			hit = (hit_case == CASE_HIT);
+
+		}
+
+		// Unit vector perpendicular to the ray
+		random_unit(state, side);
+		dot = side[0] * rd[0] + side[1] * rd[1] + side[2] * rd[2];
+
+		for(axis = 0; axis < 3; axis++) {
+			side[axis] = side[axis] - dot * rd[axis];
+
+		}
+
+		normalize(side);
+		distance = 5.0 + 15.0 * microbench_random(state);
+
+		if(spheres) {
+			set->radius[index] = 0.5 + 1.5 * microbench_random(state);
+
+			if(hit_case == CASE_GRAZING) {
+				offset = 1.0 + ((index & 1) ? MICROBENCH_GRAZE : -MICROBENCH_GRAZE);
+
+			} else {
+				offset = hit ? 0.9 * microbench_random(state) : 1.1 + 1.9 * microbench_random(state);
+
+			}
+
+			for(axis = 0; axis < 3; axis++) {
+				position[axis] = ro[axis] + distance * rd[axis] + offset * set->radius[index] * side[axis];
+				normal[axis] = 0;
+
+			}
+
+		} else {
+			set->radius[index] = 0;
+
+			for(axis = 0; axis < 3; axis++) {
+				if(hit_case == CASE_GRAZING) {
+					position[axis] = ro[axis] + distance * rd[axis] + side[axis];
+					normal[axis] = side[axis] + ((index & 1) ? MICROBENCH_GRAZE : -MICROBENCH_GRAZE) * rd[axis];
+
+				} else {
+					position[axis] = ro[axis] + (hit ? distance : -distance) * rd[axis];
+					normal[axis] = 0.7 * side[axis] - rd[axis];
+
+				}
+
+			}
+
+			normalize(normal);
+
+		}
+
+		set->x[index] = position[0];
+		set->y[index] = position[1];
+		set->z[index] = position[2];
+		set->nx[index] = normal[0];
+		set->ny[index] = normal[1];
+		set->nz[index] = normal[2];
+		set->c[index] = sphere_constant(ro, position[0], position[1], position[2], set->radius[index]);
+		set->d[index] = plane_constant(ro, position[0], position[1], position[2], normal[0], normal[1], normal[2]);
+
+	}
+
+}
+
+
+/**
+ * pass_sphere_intersection
+ *
+ * @param set - test set
+ * @param passes - number of passes over the set
+ * @returns sum of the t values
+ * @description one sphere_intersection call per test
+ */
+static double pass_sphere_intersection(TestSet *set, int passes) {
+	double sum = 0;
+	int pass, index;
+
+	for(pass = 0; pass < passes; pass++) {
+		for(index = 0; index < MICROBENCH_TESTS; index++) {
+			sum += sphere_intersection(set->ro[index / SIMD_BATCH], set->rd[index / SIMD_BATCH], set->position[index], set->radius[index]);
+
+		}
+
+	}
+
+	return sum;
+
+}
+
+
+/**
+ * pass_plane_intersection
+ *
+ * @param set - test set
+ * @param passes - number of passes over the set
+ * @returns sum of the t values
+ * @description one plane_intersection call per test
+ */
+static double pass_plane_intersection(TestSet *set, int passes) {
+	double sum = 0;
+	int pass, index;
+
+	for(pass = 0; pass < passes; pass++) {
+		for(index = 0; index < MICROBENCH_TESTS; index++) {
+			sum += plane_intersection(set->ro[index / SIMD_BATCH], set->rd[index / SIMD_BATCH], set->position[index], set->normal[index]);
+
+		}
+
+	}
+
+	return sum;
+
+}
+
+
+/**
+ * pass_sphere_packet
+ *
+ * @param set - test set
+ * @param passes - number of passes over the set
+ * @returns sum of the first t value of every batch
+ * @description one packet kernel call per ray, SIMD_BATCH spheres per call
+ */
+static double pass_sphere_packet(TestSet *set, int passes) {
+	double sum = 0;
+	int pass, index;
+
+	for(pass = 0; pass < passes; pass++) {
+		for(index = 0; index < MICROBENCH_TESTS; index += SIMD_BATCH) {
+			sphere_packet(set->ro[index / SIMD_BATCH], set->rd[index / SIMD_BATCH], &set->x[index], &set->y[index], &set->z[index],
+				&set->c[index], SIMD_BATCH, &set->t[index]);
+			sum += set->t[index];
+
+		}
+
+	}
+
+	return sum;
+
+}
+
+
+/**
+ * pass_plane_packet
+ *
+ * @param set - test set
+ * @param passes - number of passes over the set
+ * @returns sum of the first t value of every batch
+ * @description one packet kernel call per ray, SIMD_BATCH planes per call
+ */
+static double pass_plane_packet(TestSet *set, int passes) {
+	double sum = 0;
+	int pass, index;
+
+	for(pass = 0; pass < passes; pass++) {
+		for(index = 0; index < MICROBENCH_TESTS; index += SIMD_BATCH) {
+			plane_packet(set->rd[index / SIMD_BATCH], &set->nx[index], &set->ny[index], &set->nz[index], &set->d[index],
+				SIMD_BATCH, &set->t[index]);
+			sum += set->t[index];
+
+		}
+
+	}
+
+	return sum;
+
+}
+
+
+/**
+ * pass_normalize
+ *
+ * @param set - test set
+ * @param passes - number of passes over the set
+ * @returns sum of the normalized x components
+ * @description normalizes a copy of every primitive position, the copy is part of the cost
+ */
+static double pass_normalize(TestSet *set, int passes) {
+	double sum = 0;
+	double v[3];
+	int pass, index;
+
+	for(pass = 0; pass < passes; pass++) {
+		for(index = 0; index < MICROBENCH_TESTS; index++) {
+			v[0] = set->position[index][0];
+			v[1] = set->position[index][1];
+			v[2] = set->position[index][2];
+			normalize(v);
+			sum += v[0];
+
+		}
+
+	}
+
+	return sum;
+
+}
+
+
+/**
+ * microbench_now
+ *
+ * @returns milliseconds on a monotonic clock
+ * @description reads the clock the repetitions are timed with
+ */
+static double microbench_now(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return(now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0);
+
+}
+
+
+/**
+ * compare_doubles
+ *
+ * @param a - first double
+ * @param b - second double
+ * @returns negative, zero, or positive as a is below, equal to, or above b
+ * @description qsort comparison for the repetition timings
+ */
+static int compare_doubles(const void *a, const void *b) {
+	double left = *(const double *)a;
+	double right = *(const double *)b;
+
+	return((left > right) - (left < right));
+
+}
+
+
+/**
+ * measure
+ *
+ * @param name - kernel name for the report
+ * @param hit_case - case name for the report
+ * @param hit_rate - share of the tests that hit, negative when it does not apply
+ * @param pass - kernel to time
+ * @param set - test set
+ * @param warmup - untimed repetitions
+ * @param repeat - timed repetitions
+ * @param first - 1 for the first record of the report
+ * @returns void
+ * @description doubles the passes per repetition until one takes MICROBENCH_REP_MS, runs the
+ * warmup repetitions, then times repeat repetitions and prints the nanoseconds per test as the
+ * minimum, median, mean, standard deviation, and maximum over the repetitions
+ */
+static void measure(const char *name, const char *hit_case, double hit_rate, KernelPass pass, TestSet *set, int warmup, int repeat, int first) {
+	double *samples, start, elapsed, mean, deviation;
+	int passes, count;
+
+	samples = malloc(sizeof(double) * repeat);
+
+	if(samples == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	passes = 1;
+
+	for(;;) {
+		start = microbench_now();
+		microbench_sink = pass(set, passes);
+		elapsed = microbench_now() - start;
+
+		if((elapsed >= MICROBENCH_REP_MS) || (passes >= (1 << 24))) {
+			break;
+
+		}
+
+		passes = passes * 2;
+
+	}
+
+	for(count = 0; count < warmup; count++) {
+		microbench_sink = pass(set, passes);
+
+	}
+
+	mean = 0;
+
+	for(count = 0; count < repeat; count++) {
+		start = microbench_now();
+		microbench_sink = pass(set, passes);
+		elapsed = microbench_now() - start;
+		samples[count] = elapsed * 1000000.0 / ((double)passes * MICROBENCH_TESTS);
+		mean = mean + samples[count];
+
+	}
+
+	mean = mean / repeat;
+	deviation = 0;
+
+	for(count = 0; count < repeat; count++) {
+		deviation = deviation + sqr(samples[count] - mean);
+
+	}
+
+	deviation = (repeat > 1) ? sqrt(deviation / (repeat - 1)) : 0;
+	qsort(samples, repeat, sizeof(double), compare_doubles);
+
+	printf("%s\n    {\"kernel\": \"%s\", \"case\": \"%s\", ", first ? "" : ",", name, hit_case);
+
+	if(hit_rate >= 0) {
+		printf("\"hit_rate\": %.3f, ", hit_rate);
+
+	}
+
+	printf("\"passes\": %d, \"ns_min\": %.3f, \"ns_median\": %.3f, \"ns_mean\": %.3f, \"ns_stddev\": %.3f, \"ns_max\": %.3f}",
+		passes, samples[0], (repeat % 2) ? samples[repeat / 2] : (samples[repeat / 2 - 1] + samples[repeat / 2]) / 2.0,
+		mean, deviation, samples[repeat - 1]);
+	fflush(stdout);
+
+	free(samples);
+
+}
+
+
+/**
+ * hit_rate
+ *
+ * @param set - test set
+ * @param spheres - 1 for a sphere set, 0 for a plane set
+ * @returns share of the tests with a hit in front of the ray
+ * @description checks the generated set against the scalar functions
+ */
+static double hit_rate(TestSet *set, int spheres) {
+	double t;
+	int index, hits;
+
+	hits = 0;
+
+	for(index = 0; index < MICROBENCH_TESTS; index++) {
+		if(spheres) {
+			t = sphere_intersection(set->ro[index / SIMD_BATCH], set->rd[index / SIMD_BATCH], set->position[index], set->radius[index]);
+
+		} else {
+			t = plane_intersection(set->ro[index / SIMD_BATCH], set->rd[index / SIMD_BATCH], set->position[index], set->normal[index]);
+
+		}
+
+		hits = hits + (t >= 0);
+
+	}
+
+	return((double)hits / MICROBENCH_TESTS);
+
+}
+
+
+/**
+ * microbench_run
+ *
+ * @param seed - seed of the test set generator
+ * @param warmup - untimed repetitions before each measurement
+ * @param repeat - timed repetitions of each measurement
+ * @param level - instruction set of the installed packet kernels, for the report
+ * @returns void
+ * @description times sphere_intersection, plane_intersection, and the packet kernels on sets
+ * that miss, hit half the time, hit, and graze, and normalize on the sphere positions. The
+ * report is written to stdout as json, hit_rate is measured on the generated set.
+ */
+void microbench_run(unsigned int seed, int warmup, int repeat, SimdLevel level) {
+	TestSet *set;
+	HitCase hit_case;
+	unsigned int state;
+	double rate;
+	int spheres, first;
+
+	set = malloc(sizeof(TestSet));
+
+	if(set == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	printf("{\n  \"seed\": %u,\n  \"simd\": \"%s\",\n  \"warmup\": %d,\n  \"repeat\": %d,\n  \"tests\": %d,\n  \"kernels\": [",
+		seed, simd_level_name(level), warmup, repeat, MICROBENCH_TESTS);
+
+	first = 1;
+
+	for(spheres = 1; spheres >= 0; spheres--) {
+		for(hit_case = CASE_MISS; hit_case <= CASE_GRAZING; hit_case++) {
+			state = (seed ^ ((unsigned int)(spheres * 4 + hit_case) * 0x9E3779B9u));
+			state = (state != 0) ? state : 1;
+			generate_set(set, spheres, hit_case, &state);
+			rate = hit_rate(set, spheres);
+
+			if(spheres) {
+				measure("sphere_intersection", microbench_case_name(hit_case), rate, pass_sphere_intersection, set, warmup, repeat, first);
+				measure("sphere_packet", microbench_case_name(hit_case), rate, pass_sphere_packet, set, warmup, repeat, 0);
+
+				if(hit_case == CASE_MISS) {
+					measure("normalize", "positions", -1, pass_normalize, set, warmup, repeat, 0);
+
+				}
+
+			} else {
+				measure("plane_intersection", microbench_case_name(hit_case), rate, pass_plane_intersection, set, warmup, repeat, 0);
+				measure("plane_packet", microbench_case_name(hit_case), rate, pass_plane_packet, set, warmup, repeat, 0);
+
+			}
+
+			first = 0;
+
+		}
+
+	}
+
+	printf("\n  ]\n}\n");
+
+	free(set);
+
+}
@@ -0,0 +1,62 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: microbench.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef microbench_h
+#define microbench_h
+
+// Ray and primitive pairs in one test set, small enough to stay in cache
+#define MICROBENCH_TESTS 4096
+
+// Shortest time in milliseconds one timed repetition of a test set may take
+#define MICROBENCH_REP_MS 5.0
+
+// Relative distance from the silhouette of a grazing ray, and slope of a grazing ray into a plane
+#define MICROBENCH_GRAZE 1e-9
+
+/**
+ * HitCase
+ *
+ * @description share of the tests in a set that hit their primitive. Grazing rays pass the
+ * silhouette of a sphere or run almost parallel to a plane, they land on either side of the edge.
+ */
+typedef enum HitCase {
+	CASE_MISS = 0,
+	CASE_HALF,
+	CASE_HIT,
+	CASE_GRAZING
+
+} HitCase;
+
+
+/**
+ * TestSet
+ *
+ * @description pregenerated intersection tests. Test i intersects ray i / SIMD_BATCH with
+ * primitive i, so the packet kernels see a whole batch per ray just as the render loop does.
+ * Primitives are stored both as vectors for the scalar functions and as structure of arrays
+ * columns for the packet kernels. Spheres use position and radius, planes position and normal,
+ * the packet kernels take the prepared constants c and d for the test's ray origin instead.
+ */
+typedef struct TestSet {
+	double ro[MICROBENCH_TESTS / SIMD_BATCH][3];
+	double rd[MICROBENCH_TESTS / SIMD_BATCH][3];
+	double position[MICROBENCH_TESTS][3];
+	double normal[MICROBENCH_TESTS][3];
+	double radius[MICROBENCH_TESTS];
+	double x[MICROBENCH_TESTS], y[MICROBENCH_TESTS], z[MICROBENCH_TESTS];
+	double nx[MICROBENCH_TESTS], ny[MICROBENCH_TESTS], nz[MICROBENCH_TESTS];
+	double c[MICROBENCH_TESTS], d[MICROBENCH_TESTS];
+	double t[MICROBENCH_TESTS];
+
+} TestSet;
+
+// function declarations
+const char *microbench_case_name(HitCase hit_case);
+void microbench_run(unsigned int seed, int warmup, int repeat, SimdLevel level);
+
+#endif
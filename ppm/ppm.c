@@ -10,8 +10,68 @@
 #include <stdio.h>
 #include <string.h>
 #include <ctype.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "..\threadpool\threadpool.h"
 #include "ppm.h"
 
+/**
+ * PpmStream
+ *
+ * @description P6 image written band by band by a background thread. Rendered bands travel to
+ * the writer through the ready queue in image order, written band buffers travel back through
+ * the free queue, so only num_bands bands are ever held in memory.
+ */
+struct PpmStream {
+	FILE *fpointer;
+	int width;
+	int num_bands;
+	PpmBand *bands;
+	Queue *ready;
+	Queue *free;
+	pthread_t writer;
+
+};
+
+
+/**
+ * PpmMap
+ *
+ * @description ppm file mapped into memory. An output P6 file is rendered straight into the
+ * mapping behind the header. An input P6 file is read in place from its mapping, an input P3 file
+ * is decoded into pixels, which the PpmMap owns. descriptor is -1 for input files.
+ */
+struct PpmMap {
+	int descriptor;
+	unsigned char *mapping;
+	size_t size;
+	Pixel *pixels;
+
+};
+
+
+/**
+ * P3Scan
+ *
+ * @description a slice [begin, end) of the ASCII data of a P3 file. The first pass counts the
+ * values starting in the slice, the second pass decodes them starting at value index first.
+ * error is set when the slice holds a value that is not an 8-bit integer.
+ */
+typedef struct P3Scan {
+	const unsigned char *start, *begin, *end, *limit;
+	size_t first, count;
+	size_t num_values;
+	Pixel *pixels;
+	int error;
+
+} P3Scan;
+
+// Smallest slice of P3 data worth handing to another thread
+#define P3_SCAN_MIN (1 << 16)
+
 /**
  * check_rgb_bits
  *
@@ -42,134 +102,36 @@ int check_rgb_bits(int red, int green, int blue, int max, int min) {
  * @param image - an image structure
  * @returns void
  * @description takes in two pointers as parameters, a filename of a ppm image and image structure
- * use to store data read in from the ppm image file.
+ * use to store data read in from the ppm image file. The file is read by ppm_map_read, image_data
+ * is a malloc'd copy that belongs to the caller.
  */
 void read_image(char *filename, Image *image) {
-	
-    char buffer[64];
-	FILE *fpointer;
-	int row, column, red, green, blue;
-	
-	// Open file steam for reading
-	fpointer = fopen(filename, "r");
-	
-	// Check to see if file was opened successfully
-	if(fpointer == NULL) {
-		fprintf(stderr, "Error, unable to open file.\n");
+	PpmMap *map;
+	Pixel *pixels;
 
-		// Close file stream flush all buffers
-		fclose(fpointer);
-		exit(-1);
-		 
-	} else {
-		// Make sure we are reading from the beginning of the file
-		rewind(fpointer);
+	map = ppm_map_read(filename, image, NULL);
 
-		// Read in the first to characters
-		buffer[0] = fgetc(fpointer);
-		buffer[1] = fgetc(fpointer);
+	if(map->pixels != NULL) {
+		// Decoded P3 pixels are handed over as they are
+		pixels = map->pixels;
+		map->pixels = NULL;
 
-		// Check the magic number
-		if((buffer[0] == 'P') && (buffer[1] == '6')) {
-			image->magic_number = "P6";
+	} else {
+		pixels = malloc(sizeof(Pixel) * image->width * image->height);
 
-		} else if((buffer[0] == 'P') && (buffer[1] == '3')) {
-			image->magic_number = "P3";
+		if(pixels == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
 
-		} else {
-			 fprintf(stderr, "Error, unacceptable image format while reading in the file.\n Magic number must be P6 or P3.\n");
-			 exit(-2);
-			 
 		}
 
-		// Ignore comments, whitespaces, carrage returns, and tabs
-		while(isdigit(buffer[0]) == 0){
-			// If you run into a comment proceed till you reach an newline character
-			if(buffer[0] == '#') {
-				do {
-					buffer[0] = fgetc(fpointer);
-					
-				} while(buffer[0] != '\n');
-
-			} else {
-				buffer[0] = fgetc(fpointer);
-				
-			}
+		memcpy(pixels, image->image_data, sizeof(Pixel) * image->width * image->height);
 
-		}
-		
-		// Move back one character, tried using 
-		ungetc(buffer[0], fpointer);
-
-		// Read in <width> whitespace <height>
-		if(fscanf(fpointer, "%d %d", &image->width, &image->height) != 2) {
-			 fprintf(stderr, "Error, invalid width and/or height while reading in the file.\n");
-			 exit(-2);
-			 
-		}
-		
-		// Read in <maximum color value>
-		if(fscanf(fpointer, "%d", &image->max_color) != 1) {
-			 fprintf(stderr, "Error, invalid maximum color value.\n");
-			 exit(-2);
-			 
-		}
-
-		// Validate 8-bit color value
-		if((image->max_color > 255) || (image->max_color < 0)) {
-			 fprintf(stderr, "Error, input file's maximum color value is not 8-bits per channel.\n");
-			 exit(-2);
-			 
-		}
-		
-		// Allocated memory size for image data
-		image->image_data = malloc(sizeof(Pixel) * image->width * image->height);
+	}
 
-		// If magic number is P6 fread, if magic number is P3 for loop
-		if(image->magic_number[1] == '6') {
-			// Advance the file pointer by one char
-			fgetc(fpointer);
-			
-			// Read in raw image data
-			fread(image->image_data, sizeof(Pixel), image->width * image->height, fpointer);
-						
-		} else if(image->magic_number[1] == '3') {
-			// Read in ascii image data
-			for(row = 0; row < image->height; row++) {
-				for(column = 0; column < image->width; column++) {					
-
-					// Have to store values into int, larger values more then 1 byte will be truncated
-					// therefore making it not possible to check for color channels values over 8-bits	
-					fscanf(fpointer, "%d", &red);
-					fscanf(fpointer, "%d", &green);
-					fscanf(fpointer, "%d", &blue);					
-					
-					if(check_rgb_bits(red, green, blue, 255, 0) == 1) {
-						fprintf(stderr, "Error, a channel color value is not 8-bits.\n");
-						exit(-3);
-						
-					} else {
-						image->image_data[(image->width) * row + column].red = red;
-						image->image_data[(image->width) * row + column].green = green;
-						image->image_data[(image->width) * row + column].blue = blue;
-						
-					}					
-		
-				}
-				
-			}
-			
-		} else {
-			fprintf(stderr, "Error, invalid magic number.\n");
-			exit(-2);
-			
-		}
+	ppm_map_close(map);
+	image->image_data = pixels;
 
-		// Close file stream flush all buffers
-		fclose(fpointer);	
-		
-	}
-	
 }
 
 
@@ -210,6 +172,183 @@ void write_p6_image(char *filename, Image *image) {
 }
 
 
+/**
+ * P3Chunk
+ *
+ * @description rows [y0, y1) of an image formatted as P3 text into buffer, length bytes long
+ */
+typedef struct P3Chunk {
+	Image *image;
+	int y0, y1;
+	char *buffer;
+	size_t length;
+
+} P3Chunk;
+
+// Rows formatted as one unit of work
+#define P3_CHUNK_ROWS 16
+
+// Longest channel value, three digits and a newline
+#define P3_CHANNEL_SIZE 4
+
+// Every channel value as text followed by a newline, zero padded to P3_CHANNEL_SIZE bytes
+static char p3_digits[256][P3_CHANNEL_SIZE];
+static unsigned char p3_lengths[256];
+static pthread_once_t p3_once = PTHREAD_ONCE_INIT;
+
+/**
+ * p3_table
+ *
+ * @returns void
+ * @description fills in the decimal strings of the 256 channel values, runs once
+ */
+static void p3_table(void) {
+	int value;
+
+	for(value = 0; value < 256; value++) {
+		p3_lengths[value] = sprintf(p3_digits[value], "%d\n", value);
+
+	}
+
+}
+
+
+/**
+ * p3_format
+ *
+ * @param arg - P3Chunk to format
+ * @returns void
+ * @description formats a chunk of rows, one channel value per line, by copying whole table
+ * entries and advancing by their length. buffer has P3_CHANNEL_SIZE bytes of slack so the last
+ * copy may run past the text.
+ */
+static void p3_format(void *arg) {
+	P3Chunk *chunk = (P3Chunk *)arg;
+	Pixel *pixel, *end;
+	char *out = chunk->buffer;
+
+	pixel = &chunk->image->image_data[(size_t)chunk->image->width * chunk->y0];
+	end = &chunk->image->image_data[(size_t)chunk->image->width * chunk->y1];
+
+	for(; pixel < end; pixel++) {
+		memcpy(out, p3_digits[pixel->red], P3_CHANNEL_SIZE);
+		out += p3_lengths[pixel->red];
+		memcpy(out, p3_digits[pixel->green], P3_CHANNEL_SIZE);
+		out += p3_lengths[pixel->green];
+		memcpy(out, p3_digits[pixel->blue], P3_CHANNEL_SIZE);
+		out += p3_lengths[pixel->blue];
+
+	}
+
+	chunk->length = out - chunk->buffer;
+
+}
+
+
+/**
+ * write_p3_image_parallel
+ *
+ * @param filename - P3 image to create
+ * @param image - image to write
+ * @param pool - thread pool formatting the rows, NULL formats on the calling thread
+ * @returns void
+ * @description writes an image as an ASCII P3 portable pixmap, one channel value per line. Rows
+ * are formatted from a table of the 256 channel strings into large buffers, a group of chunks at a time, the chunks of a group are
+ * formatted in parallel and written out in order. Memory stays bounded by one group of chunks.
+ */
+void write_p3_image_parallel(char *filename, Image *image, ThreadPool *pool) {
+	P3Chunk *chunks;
+	FILE *fpointer;
+	size_t capacity;
+	int index, num_chunks, count, y0;
+
+	pthread_once(&p3_once, p3_table);
+
+	fpointer = fopen(filename, "w");
+	
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, unable to open file.\n");
+		exit(-1);
+		 
+	}
+
+	fprintf(fpointer, "%s\n", "P3");
+	fprintf(fpointer, "%d %d\n", image->width, image->height);
+	fprintf(fpointer, "%d\n", image->max_color);
+
+	// Enough chunks per group to keep every thread busy
+	num_chunks = (pool != NULL) ? pool->num_threads * 4 : 1;
+	capacity = (size_t)image->width * P3_CHUNK_ROWS * 3 * P3_CHANNEL_SIZE + P3_CHANNEL_SIZE;
+	chunks = malloc(sizeof(P3Chunk) * num_chunks);
+
+	if(chunks == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(index = 0; index < num_chunks; index++) {
+		chunks[index].image = image;
+		chunks[index].buffer = malloc(capacity);
+
+		if(chunks[index].buffer == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	for(y0 = 0; y0 < image->height; y0 += num_chunks * P3_CHUNK_ROWS) {
+		// Format a group of chunks
+		for(count = 0; (count < num_chunks) && (y0 + count * P3_CHUNK_ROWS < image->height); count++) {
+			chunks[count].y0 = y0 + count * P3_CHUNK_ROWS;
+			chunks[count].y1 = (chunks[count].y0 + P3_CHUNK_ROWS < image->height) ? chunks[count].y0 + P3_CHUNK_ROWS : image->height;
+
+			if(pool != NULL) {
+				threadpool_submit(pool, p3_format, &chunks[count]);
+
+			} else {
+				p3_format(&chunks[count]);
+
+			}
+
+		}
+
+		if(pool != NULL) {
+			threadpool_wait(pool);
+
+		}
+
+		// Write the group out in image order
+		for(index = 0; index < count; index++) {
+			if(fwrite(chunks[index].buffer, 1, chunks[index].length, fpointer) != chunks[index].length) {
+				fprintf(stderr, "Error, unable to write file.\n");
+				exit(-1);
+
+			}
+
+		}
+
+	}
+
+	for(index = 0; index < num_chunks; index++) {
+		free(chunks[index].buffer);
+
+	}
+
+	free(chunks);
+
+	// Close file stream flush all buffers
+	if(fclose(fpointer) != 0) {
+		fprintf(stderr, "Error, unable to write file.\n");
+		exit(-1);
+
+	}
+
+}
+
+
 /**
  * write_p3_image
  *
@@ -217,48 +356,676 @@ void write_p6_image(char *filename, Image *image) {
  * @param image - an image structure
  * @returns void
  * @description this function writes raw data into ppm p3 ASCII format. Accepts two parameters, a pointer to a
- * file stream and a poiner to an image structure. This function uses fprintf to write to the file stream
- * using a nested loop, converting integers to strings using sprintf then wites the string to an 
- * output.
+ * file name and a poiner to an image structure. The rows are formatted on the calling thread by
+ * write_p3_image_parallel.
  */
 void write_p3_image(char *filename, Image *image) {
-	int row, column;
-	char buffer[64];
-	FILE *fpointer;
-	
-	fpointer = fopen(filename, "w");
+	write_p3_image_parallel(filename, image, NULL);
 	
-	if(fpointer == NULL) {
+}
+
+
+/**
+ * ppm_stream_writer
+ *
+ * @param arg - PpmStream
+ * @returns NULL
+ * @description writer thread, writes bands in the order they are submitted until the stream is
+ * closed and hands every written band buffer back for reuse
+ */
+static void *ppm_stream_writer(void *arg) {
+	PpmStream *stream = (PpmStream *)arg;
+	PpmBand *band;
+	size_t count;
+
+	while((band = queue_pop(stream->ready)) != NULL) {
+		count = (size_t)stream->width * band->rows;
+
+		if(fwrite(band->pixels, sizeof(Pixel), count, stream->fpointer) != count) {
+			fprintf(stderr, "Error, unable to write file.\n");
+			exit(-1);
+
+		}
+
+		queue_push(stream->free, band);
+
+	}
+
+	return NULL;
+
+}
+
+
+/**
+ * ppm_stream_open
+ *
+ * @param filename - P6 image to create
+ * @param image - width, height, and maximum color of the image, image_data is not used
+ * @param band_rows - most rows in one band
+ * @param num_bands - number of band buffers, bounds the memory held by the stream
+ * @returns a newly allocated PpmStream whose writer thread is running
+ * @description writes the P6 header and starts the writer thread, the pixel rows follow as bands
+ * are submitted
+ */
+PpmStream *ppm_stream_open(char *filename, Image *image, int band_rows, int num_bands) {
+	PpmStream *stream;
+	int index;
+
+	stream = malloc(sizeof(PpmStream));
+
+	if(stream != NULL) {
+		stream->bands = malloc(sizeof(PpmBand) * num_bands);
+
+	}
+
+	if((stream == NULL) || (stream->bands == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	stream->fpointer = fopen(filename, "wb");
+
+	if(stream->fpointer == NULL) {
 		fprintf(stderr, "Error, unable to open file.\n");
+		exit(-1);
 
-		// Close file stream flush all buffers
-		fclose(fpointer);
+	}
+
+	fprintf(stream->fpointer, "%s\n", "P6");
+	fprintf(stream->fpointer, "%d %d\n", image->width, image->height);
+	fprintf(stream->fpointer, "%d\n", image->max_color);
+
+	stream->width = image->width;
+	stream->num_bands = num_bands;
+	stream->ready = queue_create(num_bands);
+	stream->free = queue_create(num_bands);
+
+	for(index = 0; index < num_bands; index++) {
+		stream->bands[index].pixels = malloc(sizeof(Pixel) * image->width * band_rows);
+		stream->bands[index].rows = 0;
+
+		if(stream->bands[index].pixels == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		queue_push(stream->free, &stream->bands[index]);
+
+	}
+
+	if(pthread_create(&stream->writer, NULL, ppm_stream_writer, stream) != 0) {
+		fprintf(stderr, "Error, unable to create writer thread.\n");
 		exit(-1);
-		 
+
+	}
+
+	return stream;
+
+}
+
+
+/**
+ * ppm_stream_band
+ *
+ * @param stream - stream
+ * @returns an empty band buffer, band_rows rows of width pixels
+ * @description waits for a band buffer the writer is done with
+ */
+PpmBand *ppm_stream_band(PpmStream *stream) {
+	return queue_pop(stream->free);
+
+}
+
+
+/**
+ * ppm_stream_submit
+ *
+ * @param stream - stream
+ * @param band - band obtained from ppm_stream_band with its rows filled in
+ * @returns void
+ * @description queues a band for writing, bands are written in the order they are submitted
+ */
+void ppm_stream_submit(PpmStream *stream, PpmBand *band) {
+	queue_push(stream->ready, band);
+
+}
+
+
+/**
+ * ppm_stream_close
+ *
+ * @param stream - stream
+ * @returns void
+ * @description waits for the writer to finish the submitted bands, closes the image file and
+ * releases the stream
+ */
+void ppm_stream_close(PpmStream *stream) {
+	int index;
+
+	queue_close(stream->ready);
+	pthread_join(stream->writer, NULL);
+
+	// Close file stream flush all buffers
+	if(fclose(stream->fpointer) != 0) {
+		fprintf(stderr, "Error, unable to write file.\n");
+		exit(-1);
+
+	}
+
+	for(index = 0; index < stream->num_bands; index++) {
+		free(stream->bands[index].pixels);
+
+	}
+
+	queue_destroy(stream->ready);
+	queue_destroy(stream->free);
+	free(stream->bands);
+	free(stream);
+
+}
+
+
+/**
+ * ppm_map_open
+ *
+ * @param filename - P6 image to create
+ * @param image - width, height, and maximum color of the image, image_data is pointed at the
+ * pixels of the mapped file
+ * @returns a newly allocated PpmMap
+ * @description creates the P6 file at its final size, maps it, writes the header, and hands the
+ * mapped pixel area to the image so rendering writes the file directly. The pixels start out
+ * black.
+ */
+PpmMap *ppm_map_open(char *filename, Image *image) {
+	PpmMap *map;
+	char header[64];
+	int length;
+
+	map = malloc(sizeof(PpmMap));
+
+	if(map == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	length = snprintf(header, sizeof(header), "%s\n%d %d\n%d\n", "P6", image->width, image->height, image->max_color);
+	map->size = length + sizeof(Pixel) * (size_t)image->width * image->height;
+	map->descriptor = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if(map->descriptor < 0) {
+		fprintf(stderr, "Error, unable to open file.\n");
+		exit(-1);
+
+	}
+
+	// Reserve the blocks up front, running out of space later would fault inside the renderer
+	if(posix_fallocate(map->descriptor, 0, map->size) != 0) {
+		fprintf(stderr, "Error, unable to write file.\n");
+		close(map->descriptor);
+		exit(-1);
+
+	}
+
+	map->mapping = mmap(NULL, map->size, PROT_READ | PROT_WRITE, MAP_SHARED, map->descriptor, 0);
+
+	if(map->mapping == MAP_FAILED) {
+		fprintf(stderr, "Error, unable to map file.\n");
+		close(map->descriptor);
+		exit(-1);
+
+	}
+
+	memcpy(map->mapping, header, length);
+	map->pixels = NULL;
+	image->image_data = (Pixel *)(map->mapping + length);
+
+	return map;
+
+}
+
+
+/**
+ * ppm_map_close
+ *
+ * @param map - mapped ppm file
+ * @returns void
+ * @description unmaps and closes the ppm file, the kernel writes the rendered pages of an output
+ * file back. Pixels decoded from a P3 file are released.
+ */
+void ppm_map_close(PpmMap *map) {
+	munmap(map->mapping, map->size);
+
+	if((map->descriptor >= 0) && (close(map->descriptor) != 0)) {
+		fprintf(stderr, "Error, unable to write file.\n");
+		exit(-1);
+
+	}
+
+	free(map->pixels);
+	free(map);
+
+}
+
+
+/**
+ * scan_header_value
+ *
+ * @param cursor - position in the mapped file, advanced past the value
+ * @param end - end of the mapped file
+ * @param value - receives the value
+ * @returns 1 if a value was read, 0 otherwise
+ * @description reads a header integer the way fscanf("%d") does, skipping leading whitespace
+ */
+static int scan_header_value(const unsigned char **cursor, const unsigned char *end, int *value) {
+	const unsigned char *position = *cursor;
+	long long number = 0;
+	int negative = 0, digits = 0;
+
+	while((position < end) && (isspace(*position) != 0)) {
+		position++;
+
+	}
+
+	if((position < end) && ((*position == '+') || (*position == '-'))) {
+		negative = (*position == '-');
+		position++;
+
+	}
+
+	while((position < end) && (isdigit(*position) != 0)) {
+		if(number < 0x7fffffff) {
+			number = number * 10 + (*position - '0');
+
+		}
+
+		digits = digits + 1;
+		position++;
+
+	}
+
+	if(digits == 0) {
+		return(0);
+
+	}
+
+	if(number > 0x7fffffff) {
+		number = 0x7fffffff;
+
+	}
+
+	*value = negative ? -(int)number : (int)number;
+	*cursor = position;
+
+	return(1);
+
+}
+
+
+/**
+ * p3_space
+ *
+ * @param character - byte of P3 data
+ * @returns non zero for the whitespace characters isspace accepts in the "C" locale
+ * @description inline whitespace test for the P3 scanner's inner loops
+ */
+static inline int p3_space(unsigned char character) {
+	return (character == ' ') || ((character >= '\t') && (character <= '\r'));
+
+}
+
+
+/**
+ * p3_first_value
+ *
+ * @param scan - P3Scan
+ * @returns position of the first value starting inside the slice, or the end of the slice
+ * @description skips the tail of a value that started in the previous slice
+ */
+static const unsigned char *p3_first_value(P3Scan *scan) {
+	const unsigned char *position = scan->begin;
+
+	if(position != scan->start) {
+		while((position < scan->end) && (p3_space(position[-1]) == 0)) {
+			position++;
+
+		}
+
+	}
+
+	return position;
+
+}
+
+
+/**
+ * p3_count
+ *
+ * @param arg - P3Scan
+ * @returns void
+ * @description first pass, counts the values that start inside the slice, that is every
+ * non-whitespace byte that follows whitespace. The loop has no branches so it vectorizes.
+ */
+static void p3_count(void *arg) {
+	P3Scan *scan = (P3Scan *)arg;
+	const unsigned char *position = scan->begin;
+	size_t count = 0;
+	int previous, current;
+
+	previous = (position == scan->start) ? 1 : p3_space(position[-1]);
+
+	for(; position < scan->end; position++) {
+		current = p3_space(*position);
+		count = count + (previous & !current);
+		previous = current;
+
+	}
+
+	scan->count = count;
+
+}
+
+
+/**
+ * p3_decode
+ *
+ * @param arg - P3Scan
+ * @returns void
+ * @description second pass, converts the values that start inside the slice and stores them as
+ * channels of the pixels, count becomes the number of values stored. Values outside 0 to 255 fail the check_rgb_bits test and mark the slice
+ * as failed, so do values that are not integers.
+ */
+static void p3_decode(void *arg) {
+	P3Scan *scan = (P3Scan *)arg;
+	const unsigned char *position;
+	unsigned char *channels = (unsigned char *)scan->pixels;
+	size_t index = scan->first;
+	int value, negative, digits;
+
+	position = p3_first_value(scan);
+
+	while((position < scan->end) && (index < scan->num_values)) {
+		if(p3_space(*position) != 0) {
+			position++;
+			continue;
+
+		}
+
+		// A value starts here, it may run past the end of the slice
+		negative = 0;
+		digits = 0;
+		value = 0;
+
+		if((*position == '+') || (*position == '-')) {
+			negative = (*position == '-');
+			position++;
+
+		}
+
+		while((position < scan->limit) && ((unsigned)(*position - '0') < 10)) {
+			if(value < 1000) {
+				value = value * 10 + (*position - '0');
+
+			}
+
+			digits = digits + 1;
+			position++;
+
+		}
+
+		value = negative ? -value : value;
+
+		if((digits == 0) || ((position < scan->limit) && (p3_space(*position) == 0)) ||
+			(check_rgb_bits(value, value, value, 255, 0) == 1)) {
+			scan->error = 1;
+			return;
+
+		}
+
+		channels[index] = value;
+		index = index + 1;
+
+	}
+
+	scan->count = index - scan->first;
+
+}
+
+
+/**
+ * p3_scan
+ *
+ * @param data - first byte of the ASCII image data
+ * @param limit - end of the mapped file
+ * @param pixels - receives the pixels
+ * @param num_pixels - number of pixels of the image
+ * @param pool - thread pool decoding the slices, NULL decodes on the calling thread
+ * @returns void
+ * @description decodes P3 image data. With a thread pool the data is cut into slices which are
+ * counted in parallel, a running sum of the counts tells each slice where its values go, and the
+ * slices are then decoded in parallel. Small files and calls without a pool decode in one pass.
+ */
+static void p3_scan(const unsigned char *data, const unsigned char *limit, Pixel *pixels, size_t num_pixels, ThreadPool *pool) {
+	P3Scan *scans;
+	size_t length, slice, total;
+	int index, num_scans;
+
+	length = limit - data;
+	num_scans = (pool != NULL) ? pool->num_threads * 4 : 1;
+
+	if(length / P3_SCAN_MIN < (size_t)num_scans) {
+		num_scans = (int)(length / P3_SCAN_MIN) + 1;
+
+	}
+
+	slice = length / num_scans + 1;
+	scans = malloc(sizeof(P3Scan) * num_scans);
+
+	if(scans == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	for(index = 0; index < num_scans; index++) {
+		scans[index].start = data;
+		scans[index].begin = data + ((slice * index < length) ? slice * index : length);
+		scans[index].end = data + ((slice * (index + 1) < length) ? slice * (index + 1) : length);
+		scans[index].limit = limit;
+		scans[index].first = 0;
+		scans[index].count = 0;
+		scans[index].num_values = num_pixels * 3;
+		scans[index].pixels = pixels;
+		scans[index].error = 0;
+
+	}
+
+	// A single slice is decoded straight away, its values start at index 0
+	if(num_scans > 1) {
+		for(index = 0; index < num_scans; index++) {
+			threadpool_submit(pool, p3_count, &scans[index]);
+
+		}
+
+		threadpool_wait(pool);
+
+		for(index = 1; index < num_scans; index++) {
+			scans[index].first = scans[index - 1].first + scans[index - 1].count;
+
+		}
+
+		for(index = 0; index < num_scans; index++) {
+			threadpool_submit(pool, p3_decode, &scans[index]);
+
+		}
+
+		threadpool_wait(pool);
+
 	} else {
-		fprintf(fpointer, "%s\n", "P3");
-		fprintf(fpointer, "%d %d\n", image->width, image->height);
-		fprintf(fpointer, "%d\n", image->max_color);
-		
-		// Read in ascii image data
-		for(row = 0; row < (image->height); row++) {
-			for(column = 0; column < (image->width); column++) {
-				sprintf(buffer, "%d", image->image_data[(image->width) * row + column].red);
-				fprintf(fpointer, "%s\n", buffer);
-				
-				sprintf(buffer, "%d", image->image_data[(image->width) * row + column].green);
-				fprintf(fpointer, "%s\n", buffer);
-				
-				sprintf(buffer, "%d", image->image_data[(image->width) * row + column].blue);
-				fprintf(fpointer, "%s\n", buffer);				
-		
+		p3_decode(&scans[0]);
+
+	}
+
+	for(index = 0; index < num_scans; index++) {
+		if(scans[index].error) {
+			fprintf(stderr, "Error, a channel color value is not 8-bits.\n");
+			exit(-3);
+
+		}
+
+	}
+
+	total = 0;
+
+	for(index = 0; index < num_scans; index++) {
+		total = total + scans[index].count;
+
+	}
+
+	if(total < num_pixels * 3) {
+		fprintf(stderr, "Error, image data is truncated.\n");
+		exit(-3);
+
+	}
+
+	free(scans);
+
+}
+
+
+/**
+ * ppm_map_read
+ *
+ * @param filename - P3 or P6 image to read
+ * @param image - receives the magic number, size, maximum color, and pixels of the image
+ * @param pool - thread pool decoding P3 data, NULL decodes on the calling thread
+ * @returns a PpmMap holding the pixels, image_data is valid until ppm_map_close
+ * @description maps a ppm file into memory. The pixels of a P6 file are used in place, the
+ * mapping is private so image_data may be written without touching the file. P3 data is decoded
+ * by p3_scan. The header is read and validated like read_image always has.
+ */
+PpmMap *ppm_map_read(char *filename, Image *image, ThreadPool *pool) {
+	PpmMap *map;
+	struct stat status;
+	const unsigned char *position, *end;
+	size_t num_pixels;
+
+	map = malloc(sizeof(PpmMap));
+
+	if(map == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	map->descriptor = open(filename, O_RDONLY);
+
+	if((map->descriptor < 0) || (fstat(map->descriptor, &status) != 0)) {
+		fprintf(stderr, "Error, unable to open file.\n");
+		exit(-1);
+
+	}
+
+	map->size = (size_t)status.st_size;
+	map->pixels = NULL;
+	map->mapping = (map->size > 0) ? mmap(NULL, map->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, map->descriptor, 0) : NULL;
+
+	// The mapping stays valid after the descriptor is closed
+	close(map->descriptor);
+	map->descriptor = -1;
+
+	if(map->mapping == MAP_FAILED) {
+		fprintf(stderr, "Error, unable to map file.\n");
+		exit(-1);
+
+	}
+
+	position = map->mapping;
+	end = map->mapping + map->size;
+
+	// Check the magic number
+	if((map->size >= 2) && (position[0] == 'P') && (position[1] == '6')) {
+		image->magic_number = "P6";
+
+	} else if((map->size >= 2) && (position[0] == 'P') && (position[1] == '3')) {
+		image->magic_number = "P3";
+
+	} else {
+		 fprintf(stderr, "Error, unacceptable image format while reading in the file.\n Magic number must be P6 or P3.\n");
+		 exit(-2);
+		 
+	}
+
+	// Ignore comments, whitespaces, carrage returns, and tabs
+	position = position + 2;
+
+	while((position < end) && (isdigit(*position) == 0)) {
+		// If you run into a comment proceed till you reach an newline character
+		if(*position == '#') {
+			while((position < end) && (*position != '\n')) {
+				position++;
+
 			}
-			
+
+		} else {
+			position++;
+
 		}
-		
-		// Close file stream flush all buffers
-		fclose(fpointer);
-		
+
+	}
+
+	// Read in <width> whitespace <height>
+	if((scan_header_value(&position, end, &image->width) == 0) || (scan_header_value(&position, end, &image->height) == 0) ||
+		(image->width <= 0) || (image->height <= 0)) {
+		 fprintf(stderr, "Error, invalid width and/or height while reading in the file.\n");
+		 exit(-2);
+		 
 	}
 	
-}
\ No newline at end of file
+	// Read in <maximum color value>
+	if(scan_header_value(&position, end, &image->max_color) == 0) {
+		 fprintf(stderr, "Error, invalid maximum color value.\n");
+		 exit(-2);
+		 
+	}
+
+	// Validate 8-bit color value
+	if((image->max_color > 255) || (image->max_color < 0)) {
+		 fprintf(stderr, "Error, input file's maximum color value is not 8-bits per channel.\n");
+		 exit(-2);
+		 
+	}
+
+	num_pixels = (size_t)image->width * image->height;
+
+	if(image->magic_number[1] == '6') {
+		// A single whitespace character separates the header from the raw image data
+		position++;
+
+		if((position > end) || ((size_t)(end - position) < sizeof(Pixel) * num_pixels)) {
+			fprintf(stderr, "Error, image data is truncated.\n");
+			exit(-3);
+
+		}
+
+		image->image_data = (Pixel *)position;
+
+	} else {
+		map->pixels = malloc(sizeof(Pixel) * num_pixels);
+
+		if(map->pixels == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		p3_scan(position, end, map->pixels, num_pixels, pool);
+		image->image_data = map->pixels;
+
+	}
+
+	return map;
+
+}
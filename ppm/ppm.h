@@ -34,8 +34,38 @@ typedef struct Image {
 
 } Image;
 
+/**
+ * PpmBand
+ *
+ * @description buffer holding a band of consecutive image rows on its way to a PpmStream
+ */
+typedef struct PpmBand {
+    Pixel *pixels;
+    int rows;
+
+} PpmBand;
+
+// Streaming P6 writer, defined in ppm.c
+typedef struct PpmStream PpmStream;
+
+// Memory mapped P6 file, defined in ppm.c
+typedef struct PpmMap PpmMap;
+
+// Thread pool formatting P3 rows, defined in threadpool.h
+struct ThreadPool;
+
 // function declarations
+int check_rgb_bits(int red, int green, int blue, int max, int min);
+void read_image(char *filename, Image *image);
 void write_p6_image(char *filename, Image *image);
 void write_p3_image(char *filename, Image *image);
+void write_p3_image_parallel(char *filename, Image *image, struct ThreadPool *pool);
+PpmStream *ppm_stream_open(char *filename, Image *image, int band_rows, int num_bands);
+PpmBand *ppm_stream_band(PpmStream *stream);
+void ppm_stream_submit(PpmStream *stream, PpmBand *band);
+void ppm_stream_close(PpmStream *stream);
+PpmMap *ppm_map_open(char *filename, Image *image);
+PpmMap *ppm_map_read(char *filename, Image *image, struct ThreadPool *pool);
+void ppm_map_close(PpmMap *map);
  
 #endif
\ No newline at end of file
@@ -11,272 +11,1206 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include <time.h>
 #include "..\ppm\ppm.h"
+#include "..\arena\arena.h"
 #include "..\json\json.h"
+#include "..\scene\scene.h"
+#include "..\simd\simd.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "..\tilebin\tilebin.h"
+#include "..\stats\stats.h"
 #include "raycaster.h"
 
 /**
- * sqr
+ * sphere_intersection
+ *
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param center - sphere center aka position
+ * @param radius - sphere radius
+ * @returns double percision float t value that represents length of the intersecting vector, and -1 if
+ * no intersection was detected.
+ * @description this function detects the distance a ray vector intersects the sphere
+ */     
+double sphere_intersection(double *ro, double *rd, double *center, double radius){
+	return sphere_hit(ro, rd, center[0], center[1], center[2], sphere_constant(ro, center[0], center[1], center[2], radius));
+
+}
+
+
+/**
+ * plane_intersection
+ *
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param pos - position
+ * @param normal - the orthogonal normal vector to the plane, expected to be unit length
+ * @returns double percision float t value that represents length of the intersecting vector, and -1 if
+ * no intersection was detected.
+ * @description this function detects the distance a ray vector intersects the plane
+ */
+double plane_intersection(double *ro, double *rd, double *pos, double *normal){
+	return plane_hit(rd, normal[0], normal[1], normal[2], plane_constant(ro, pos[0], pos[1], pos[2], normal[0], normal[1], normal[2]));
+	
+}
+
+
+/**
+ * RenderJob
+ *
+ * @description values shared by every tile of a render: the scene, the output image, and the
+ * camera derived pixel scaling. first_row is the image row stored at the start of image_data, 0
+ * unless the image is rendered band by band. deadline is the clock time in milliseconds after
+ * which a progressive render stops refining, 0 when there is none. ids receives the object each
+ * pixel's ray hit when it is not NULL, and samples is the number of rays per axis an antialiased
+ * edge pixel is supersampled with. Tiles only read from a job so one job can be handed to any
+ * number of threads.
+ */
+typedef struct RenderJob {
+	RenderScene *scene;
+	Image *image;
+	int first_row;
+	double deadline;
+	int *ids;
+	int samples;
+	double pixel_height, pixel_width;
+	double cx, cy;
+	double h, w;
+
+} RenderJob;
+
+
+/**
+ * Tile
+ *
+ * @description a rectangle of pixels [x0, x1) x [y0, y1) rendered as one unit of work. step is
+ * the block size of a progressive pass over the tile, done is set once the pass has refined it.
+ * edges counts the pixels an antialiasing pass supersampled in the tile.
+ */
+typedef struct Tile {
+	RenderJob *job;
+	int x0, y0;
+	int x1, y1;
+	int step, done;
+	int edges;
+
+} Tile;
+
+
+/**
+ * Hit
+ *
+ * @description closest intersection found so far along a ray. order is the object's index in the
+ * original scene and breaks ties between equal t values the way a scan of the object array would,
+ * index is the primitive's position in its RenderScene columns.
+ */
+typedef struct Hit {
+	double t;
+	int order;
+	ObjectKind kind;
+	int index;
+
+} Hit;
+
+
+/**
+ * hit_spheres
+ *
+ * @param scene - render scene, prepared for the origin of the ray
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param first - first sphere to test
+ * @param count - number of spheres to test
+ * @param hit - closest hit so far, updated in place
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns void
+ * @description tests a contiguous range of spheres with the packet kernels, in single precision
+ * when the scene has single precision geometry
+ */
+static inline void hit_spheres(RenderScene *scene, double *ro, double *rd, int first, int count, Hit *hit, RenderStats *counters) {
+	SingleScene *single = scene->single;
+	double t[SIMD_BATCH];
+	float t_single[SIMD_BATCH], ro_single[3], rd_single[3];
+	int index, batch, hits, start;
+
+	hits = 0;
+	start = first;
+
+	if(single != NULL) {
+		for(index = 0; index < 3; index++) {
+			ro_single[index] = (float)ro[index];
+			rd_single[index] = (float)rd[index];
+
+		}
+
+	}
+
+	for(; count > 0; first += batch, count -= batch) {
+		batch = (count < SIMD_BATCH) ? count : SIMD_BATCH;
+
+		if(single != NULL) {
+			sphere_packet_single(ro_single, rd_single, single->sphere_x + first, single->sphere_y + first, single->sphere_z + first, single->sphere_c + first, batch, t_single);
+
+			for(index = 0; index < batch; index++) {
+				t[index] = t_single[index];
+
+			}
+
+		} else {
+			sphere_packet(ro, rd, scene->sphere_x + first, scene->sphere_y + first, scene->sphere_z + first, scene->sphere_c + first, batch, t);
+
+		}
+
+		for(index = 0; index < batch; index++) {
+			if(counters != NULL) {
+				hits = hits + (t[index] > 0);
+
+			}
+
+			if((t[index] > 0) && ((t[index] < hit->t) || ((t[index] == hit->t) && (scene->sphere_order[first + index] < hit->order)))) {
+				hit->t = t[index];
+				hit->order = scene->sphere_order[first + index];
+				hit->kind = KIND_SPHERE;
+				hit->index = first + index;
+
+			}
+
+		}
+
+	}
+
+	if(counters != NULL) {
+		counters->sphere_tests += first - start;
+		counters->sphere_hits += hits;
+
+	}
+
+}
+
+
+/**
+ * hit_bins
+ *
+ * @param scene - render scene with tile bins, prepared for the origin of the ray
+ * @param tile - tile of the image the ray passes through
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param hit - closest hit so far, updated in place
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns void
+ * @description tests the spheres binned into one tile with the packet kernels, in single precision
+ * when the bins gathered single precision geometry. No sphere outside the tile's list can be hit by a
+ * ray through the tile, so the closest hit is the one a scan of every sphere finds.
+ */
+static inline void hit_bins(RenderScene *scene, int tile, double *ro, double *rd, Hit *hit, RenderStats *counters) {
+	TileBins *bins = scene->bins;
+	double t[SIMD_BATCH];
+	float t_single[SIMD_BATCH], ro_single[3], rd_single[3];
+	int index, first, last, batch, hits, sphere;
+
+	hits = 0;
+	first = bins->start[tile];
+	last = bins->start[tile + 1];
+
+	if(bins->x_single != NULL) {
+		for(index = 0; index < 3; index++) {
+			ro_single[index] = (float)ro[index];
+			rd_single[index] = (float)rd[index];
+
+		}
+
+	}
+
+	for(; first < last; first += batch) {
+		batch = (last - first < SIMD_BATCH) ? last - first : SIMD_BATCH;
+
+		if(bins->x_single != NULL) {
+			sphere_packet_single(ro_single, rd_single, bins->x_single + first, bins->y_single + first, bins->z_single + first, bins->c_single + first, batch, t_single);
+
+			for(index = 0; index < batch; index++) {
+				t[index] = t_single[index];
+
+			}
+
+		} else {
+			sphere_packet(ro, rd, bins->x + first, bins->y + first, bins->z + first, bins->c + first, batch, t);
+
+		}
+
+		for(index = 0; index < batch; index++) {
+			if(counters != NULL) {
+				hits = hits + (t[index] > 0);
+
+			}
+
+			sphere = bins->sphere[first + index];
+
+			if((t[index] > 0) && ((t[index] < hit->t) || ((t[index] == hit->t) && (scene->sphere_order[sphere] < hit->order)))) {
+				hit->t = t[index];
+				hit->order = scene->sphere_order[sphere];
+				hit->kind = KIND_SPHERE;
+				hit->index = sphere;
+
+			}
+
+		}
+
+	}
+
+	if(counters != NULL) {
+		counters->sphere_tests += bins->start[tile + 1] - bins->start[tile];
+		counters->sphere_hits += hits;
+
+	}
+
+}
+
+
+/**
+ * hit_planes
+ *
+ * @param scene - render scene, prepared for the origin of the ray
+ * @param rd - ray vector direction
+ * @param hit - closest hit so far, updated in place
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns void
+ * @description tests every plane with the packet kernels, planes are unbounded so they are never
+ * part of the bounding volume hierarchy. Single precision when the scene has single precision
+ * geometry.
+ */
+static inline void hit_planes(RenderScene *scene, double *rd, Hit *hit, RenderStats *counters) {
+	SingleScene *single = scene->single;
+	double t[SIMD_BATCH];
+	float t_single[SIMD_BATCH], rd_single[3];
+	int index, first, batch, hits;
+
+	hits = 0;
+
+	if(single != NULL) {
+		for(index = 0; index < 3; index++) {
+			rd_single[index] = (float)rd[index];
+
+		}
+
+	}
+
+	for(first = 0; first < scene->num_planes; first += batch) {
+		batch = (scene->num_planes - first < SIMD_BATCH) ? scene->num_planes - first : SIMD_BATCH;
+
+		if(single != NULL) {
+			plane_packet_single(rd_single, single->plane_nx + first, single->plane_ny + first, single->plane_nz + first, single->plane_d + first, batch, t_single);
+
+			for(index = 0; index < batch; index++) {
+				t[index] = t_single[index];
+
+			}
+
+		} else {
+			plane_packet(rd, scene->plane_nx + first, scene->plane_ny + first, scene->plane_nz + first, scene->plane_d + first, batch, t);
+
+		}
+
+		for(index = 0; index < batch; index++) {
+			if(counters != NULL) {
+				hits = hits + (t[index] > 0);
+
+			}
+
+			if((t[index] > 0) && ((t[index] < hit->t) || ((t[index] == hit->t) && (scene->plane_order[first + index] < hit->order)))) {
+				hit->t = t[index];
+				hit->order = scene->plane_order[first + index];
+				hit->kind = KIND_PLANE;
+				hit->index = first + index;
+
+			}
+
+		}
+
+	}
+
+	if(counters != NULL) {
+		counters->plane_tests += scene->num_planes;
+		counters->plane_hits += hits;
+
+	}
+
+}
+
+
+/**
+ * box_entry
+ *
+ * @param node - bounding volume hierarchy node
+ * @param ro - ray vector orgin
+ * @param inv - component wise reciprocal of the ray direction
+ * @param limit - farthest t still of interest
+ * @param entry - receives the t value where the ray enters the box
+ * @returns 1 if the ray passes through the box between 0 and limit, 0 otherwise
+ * @description slab test. A zero direction component gives a NaN slab which the comparisons
+ * ignore, so rays parallel to a face are kept conservatively.
+ */
+static inline int box_entry(const BvhNode *node, double *ro, double *inv, double limit, double *entry) {
+	double t0, t1, swap, tmin, tmax;
+	int axis;
+
+	tmin = 0;
+	tmax = limit;
+
+	for(axis = 0; axis < 3; axis++) {
+		t0 = (node->min[axis] - ro[axis]) * inv[axis];
+		t1 = (node->max[axis] - ro[axis]) * inv[axis];
+
+		if(inv[axis] < 0) {
+			swap = t0;
+			t0 = t1;
+			t1 = swap;
+
+		}
+
+		if(t0 > tmin) {
+			tmin = t0;
+
+		}
+
+		if(t1 < tmax) {
+			tmax = t1;
+
+		}
+
+	}
+
+	*entry = tmin;
+
+	return (tmin <= tmax);
+
+}
+
+
+/**
+ * hit_bvh
+ *
+ * @param scene - render scene with a bounding volume hierarchy
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param hit - closest hit so far, updated in place
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns void
+ * @description walks the hierarchy front to back, nearer child first, skipping every box that
+ * starts beyond the closest hit. Boxes starting exactly at the closest hit are still visited so
+ * ties resolve the same way as the linear scan.
+ */
+static inline void hit_bvh(RenderScene *scene, double *ro, double *rd, Hit *hit, RenderStats *counters) {
+	const BvhNode *nodes = scene->bvh->nodes;
+	int stack[BVH_MAX_DEPTH + 1];
+	double stack_t[BVH_MAX_DEPTH + 1];
+	double inv[3], limit, t_left, t_right, t_root;
+	int top, node, left, right, hit_left, hit_right;
+
+	inv[0] = 1.0 / rd[0];
+	inv[1] = 1.0 / rd[1];
+	inv[2] = 1.0 / rd[2];
+
+	if(counters != NULL) {
+		counters->box_tests += 1;
+
+	}
+
+	if(box_entry(&nodes[0], ro, inv, INFINITY, &t_root) == 0) {
+		return;
+
+	}
+
+	top = 0;
+	node = 0;
+
+	while(1) {
+		// Allow for rounding in the box test, only boxes clearly behind the hit are skipped
+		limit = hit->t * (1.0 + 1e-9);
+
+		if(nodes[node].count > 0) {
+			hit_spheres(scene, ro, rd, nodes[node].first, nodes[node].count, hit, counters);
+
+		} else {
+			if(counters != NULL) {
+				counters->box_tests += 2;
+
+			}
+
+			left = nodes[node].first;
+			right = left + 1;
+			hit_left = box_entry(&nodes[left], ro, inv, limit, &t_left);
+			hit_right = box_entry(&nodes[right], ro, inv, limit, &t_right);
+
+			if(hit_left && hit_right) {
+				if(t_right < t_left) {
+					stack[top] = left;
+					stack_t[top] = t_left;
+					node = right;
+
+				} else {
+					stack[top] = right;
+					stack_t[top] = t_right;
+					node = left;
+
+				}
+
+				top = top + 1;
+				continue;
+
+			} else if(hit_left) {
+				node = left;
+				continue;
+
+			} else if(hit_right) {
+				node = right;
+				continue;
+
+			}
+
+		}
+
+		// Pop the next box that still starts before the closest hit
+		node = -1;
+
+		while(top > 0) {
+			top = top - 1;
+
+			if(stack_t[top] <= hit->t * (1.0 + 1e-9)) {
+				node = stack[top];
+				break;
+
+			}
+
+		}
+
+		if(node < 0) {
+			break;
+
+		}
+
+	}
+
+}
+
+
+/**
+ * trace_pixel
+ *
+ * @param job - render job holding the scene and the output image
+ * @param y - image row of the sample, row + 0.5 is the center of a pixel
+ * @param x - image column of the sample, column + 0.5 is the center of a pixel
+ * @param pixel - colored with the closest intersecting object, left untouched when the ray misses
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns the scene index of the object hit, -1 when the ray misses
+ * @description casts the ray through one point of the image, finds the closest intersecting
+ * object and colors the pixel with that object's color, a compact scene's spheres look theirs up
+ * in its palette
+ */
+static inline int trace_pixel(RenderJob *job, double y, double x, Pixel *pixel, RenderStats *counters) {
+	RenderScene *scene = job->scene;
+	Image *image = job->image;
+	Hit hit;
+	double rd[3], *color;
+
+	// Rays start at the origin the scene was prepared for
+	double *ro = scene->origin;
+
+	rd[0] = (job->cx - (job->w / 2.0) + job->pixel_width * x);
+	rd[1] = - 1 * (job->cy - (job->h / 2.0) + job->pixel_height * y);
+	rd[2] = 1.0;
+	
+	// Normalize ray direction
+	normalize(rd);
+	hit.t = INFINITY;
+	hit.order = -1;
+	hit.kind = KIND_UNKNOWN;
+	hit.index = -1;
+	
+	// Get the best t value and object index
+	if(scene->bins != NULL) {
+		hit_bins(scene, scene->bins->tiles_x * ((int)y / scene->bins->tile_size) + (int)x / scene->bins->tile_size, ro, rd, &hit, counters);
+		
+	} else if(scene->bvh != NULL) {
+		hit_bvh(scene, ro, rd, &hit, counters);
+		
+	} else {
+		hit_spheres(scene, ro, rd, 0, scene->num_spheres, &hit, counters);
+		
+	}
+	
+	hit_planes(scene, rd, &hit, counters);
+	
+	if((hit.kind == KIND_SPHERE) && (scene->compact)) {
+		color = &scene->palette[3 * scene->sphere_color[hit.index]];
+		pixel->red = color[0] * (image->max_color);
+		pixel->green = color[1] * (image->max_color);
+		pixel->blue = color[2] * (image->max_color);
+		
+	} else if(hit.kind == KIND_SPHERE) {
+		pixel->red = scene->sphere_red[hit.index] * (image->max_color);
+		pixel->green = scene->sphere_green[hit.index] * (image->max_color);
+		pixel->blue = scene->sphere_blue[hit.index] * (image->max_color);
+		
+	} else if(hit.kind == KIND_PLANE) {
+		pixel->red = scene->plane_red[hit.index] * (image->max_color);
+		pixel->green = scene->plane_green[hit.index] * (image->max_color);
+		pixel->blue = scene->plane_blue[hit.index] * (image->max_color);
+		
+	}
+	
+	if(counters != NULL) {
+		counters->rays += 1;
+		counters->rays_sphere += (hit.kind == KIND_SPHERE);
+		counters->rays_plane += (hit.kind == KIND_PLANE);
+		counters->rays_missed += (hit.kind == KIND_UNKNOWN);
+		
+	}
+
+	return hit.order;
+
+}
+
+
+/**
+ * render_pixels
+ *
+ * @param job - render job holding the scene and the output image
+ * @param x0 - first column of the region
+ * @param y0 - first row of the region
+ * @param x1 - one past the last column of the region
+ * @param y1 - one past the last row of the region
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns void
+ * @description casts one ray per pixel of the region, and records the object each ray hit when
+ * the job collects ids. Every pixel is independent of every other pixel so regions may be
+ * rendered in any order and on any thread.
+ */
+static inline void render_pixels(RenderJob *job, int x0, int y0, int x1, int y1, RenderStats *counters) {
+	Image *image = job->image;
+	int row, column, offset, id;
+
+	for(row = y0; row < y1; row++) {
+		
+		for(column = x0; column < x1; column++) {
+			offset = (image->width) * (row - job->first_row) + column;
+			id = trace_pixel(job, row + 0.5, column + 0.5, &image->image_data[offset], counters);
+			
+			if(job->ids != NULL) {
+				job->ids[offset] = id;
+				
+			}
+			
+		} // EoRow Loop
+		
+	} // EoColumn Loop 
+
+}
+
+
+/**
+ * refine_pixels
+ *
+ * @param job - render job holding the scene and the output image
+ * @param x0 - first column of the region, a multiple of step
+ * @param y0 - first row of the region, a multiple of step
+ * @param x1 - one past the last column of the region
+ * @param y1 - one past the last row of the region
+ * @param step - block size of the pass
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns void
+ * @description one pass of a progressive render. The pixel at the corner of every step x step block
+ * is traced and its color fills the whole block. The first pass traces every block, later passes
+ * halve the block size and skip the corners traced by the pass before, whose colors already fill
+ * their blocks. A miss fills its block with black.
+ */
+static inline void refine_pixels(RenderJob *job, int x0, int y0, int x1, int y1, int step, RenderStats *counters) {
+	Image *image = job->image;
+	Pixel color, *pixel;
+	int row, column, y, x, y_end, x_end;
+
+	for(row = y0; row < y1; row += step) {
+		for(column = x0; column < x1; column += step) {
+			if((step < PROGRESSIVE_BLOCK) && (row % (2 * step) == 0) && (column % (2 * step) == 0)) {
+				continue;
+
+			}
+
+			color.red = 0;
+			color.green = 0;
+			color.blue = 0;
+			trace_pixel(job, row + 0.5, column + 0.5, &color, counters);
+
+			y_end = (row + step < y1) ? row + step : y1;
+			x_end = (column + step < x1) ? column + step : x1;
+
+			for(y = row; y < y_end; y++) {
+				pixel = &image->image_data[(image->width) * y];
+
+				for(x = column; x < x_end; x++) {
+					pixel[x] = color;
+
+				}
+
+			}
+
+		}
+
+	}
+
+}
+
+
+/**
+ * smooth_pixels
+ *
+ * @param job - render job holding the scene, the output image, and the ids of the first pass
+ * @param x0 - first column of the region
+ * @param y0 - first row of the region
+ * @param x1 - one past the last column of the region
+ * @param y1 - one past the last row of the region
+ * @param counters - render statistics of the calling thread, NULL when none are collected
+ * @returns number of pixels supersampled
+ * @description second pass of an antialiased render. A pixel whose ray hit another object than
+ * one of its eight neighbours' rays, or hit where a neighbour missed, lies on an edge and is
+ * traced again with samples x samples rays spread evenly over it, its color becomes their
+ * average. Pixels inside an object keep the color of their single ray, flat shading gives every
+ * sample inside an object the same color. Only the ids are read, so regions may be smoothed in
+ * any order and on any thread.
+ */
+static inline int smooth_pixels(RenderJob *job, int x0, int y0, int x1, int y1, RenderStats *counters) {
+	Image *image = job->image;
+	Pixel color;
+	int row, column, y, x, i, j, id, edge, edges, count;
+	int red, green, blue;
+
+	edges = 0;
+	count = job->samples * job->samples;
+
+	for(row = y0; row < y1; row++) {
+		for(column = x0; column < x1; column++) {
+			id = job->ids[(image->width) * row + column];
+			edge = 0;
+
+			for(y = (row > 0) ? row - 1 : row; (y <= row + 1) && (y < image->height) && (edge == 0); y++) {
+				for(x = (column > 0) ? column - 1 : column; (x <= column + 1) && (x < image->width); x++) {
+					if(job->ids[(image->width) * y + x] != id) {
+						edge = 1;
+						break;
+
+					}
+
+				}
+
+			}
+
+			if(edge == 0) {
+				continue;
+
+			}
+
+			red = 0;
+			green = 0;
+			blue = 0;
+
+			for(j = 0; j < job->samples; j++) {
+				for(i = 0; i < job->samples; i++) {
+					color.red = 0;
+					color.green = 0;
+					color.blue = 0;
+					trace_pixel(job, row + (j + 0.5) / job->samples, column + (i + 0.5) / job->samples, &color, counters);
+					red = red + color.red;
+					green = green + color.green;
+					blue = blue + color.blue;
+
+				}
+
+			}
+
+			image->image_data[(image->width) * row + column].red = (red + count / 2) / count;
+			image->image_data[(image->width) * row + column].green = (green + count / 2) / count;
+			image->image_data[(image->width) * row + column].blue = (blue + count / 2) / count;
+			edges = edges + 1;
+
+		}
+
+	}
+
+	return edges;
+
+}
+
+
+/**
+ * render_region
  *
- * @param v - double precision floating point number
- * @returns static function, no return
- * @description math operation that squares a double precision floating
+ * @param job - render job holding the scene and the output image
+ * @param x0 - first column of the region
+ * @param y0 - first row of the region
+ * @param x1 - one past the last column of the region
+ * @param y1 - one past the last row of the region
+ * @returns void
+ * @description renders a region. With --stats the region counts into its own counters, which
+ * are merged into the render statistics once it is done, otherwise the counting is compiled out.
  */
-static inline double sqr(double v) {
-	return v * v;
-	
+static void render_region(RenderJob *job, int x0, int y0, int x1, int y1) {
+	RenderStats counters;
+
+	if(stats_enabled()) {
+		memset(&counters, 0, sizeof(RenderStats));
+		render_pixels(job, x0, y0, x1, y1, &counters);
+		stats_merge(&counters);
+
+	} else {
+		render_pixels(job, x0, y0, x1, y1, NULL);
+
+	}
+
 }
 
 
 /**
- * normalize
+ * render_tile
  *
- * @param v an array storing vector information
- * @returns static function, no return 
- * @description vector normalization, divide each component by its magnitude
+ * @param arg - Tile to render
+ * @returns void
+ * @description thread pool task wrapper around render_region
  */
-static inline void normalize(double *v) {
-	double len = sqrt(sqr(v[0]) + sqr(v[1]) + sqr(v[2]));
-	v[0] /= len;
-	v[1] /= len;
-	v[2] /= len;
-	
+static void render_tile(void *arg) {
+	Tile *tile = (Tile *)arg;
+
+	render_region(tile->job, tile->x0, tile->y0, tile->x1, tile->y1);
+
 }
 
 
 /**
- * get_camera
+ * raycaster_now
  *
- * @param objects[]
- * @param num_objects used to set the counter that iterates through an array of objects 
- * @returns the index value within the array the camera was found, -1 otherwise if the camera was not found
- * @description iterates through a scene or array of objects looking for an object with type
- * camera and returns the index of that object in the scene array or -1 if no camera was found.
+ * @returns milliseconds on a monotonic clock
+ * @description reads the clock a progressive render's deadline is measured on
  */
-int get_camera(Object objects[], int num_objects) {
-	int i;
-	
-	for(i = 0; i < num_objects; i++){
-		if(strcmp((objects[i].type), "camera") == 0) {
-			return (i);
-			
-		}
-		
-	}
-	
-	return(-1);
-	
+static double raycaster_now(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return(now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0);
+
 }
 
 
 /**
- * sphere_intersection
+ * refine_tile
  *
- * @param ro - ray vector orgin
- * @param rd - ray vector direction
- * @param center - sphere center aka position
- * @param radius - sphere radius
- * @returns double percision float t value that represents length of the intersecting vector, and -1 if
- * no intersection was detected.
- * @description this function detects the distance a ray vector intersects the sphere
- */     
-double sphere_intersection(double *ro, double *rd, double *center, double radius){
-	double a, b, c, discriminant, t1, t0;
+ * @param arg - Tile to refine
+ * @returns void
+ * @description thread pool task running one progressive pass over a tile. Once the deadline has
+ * passed the tile is left as the previous pass rendered it, the first pass always runs so the
+ * whole image is covered.
+ */
+static void refine_tile(void *arg) {
+	Tile *tile = (Tile *)arg;
+	RenderStats counters;
 
-	// Step 1.) Find the equation for the object you are interested in..  
-	// Step 2.) Parameterize the equation with a center point
-	// Step 3.) Substitute the eq for a ray into our object equation.
-	// Step 4.) Solve for t.
-	// Step 4a.) Rewrite the equation (flatten).
-	
-	a = (sqr(rd[0]) + sqr(rd[1]) + sqr(rd[2]));
-	b = (2 * (rd[0] * (ro[0] - center[0]) + rd[1] * (ro[1] - center[1]) + rd[2] * (ro[2] - center[2])));
-	c = sqr(ro[0] - center[0]) + sqr(ro[1] - center[1]) + sqr(ro[2] - center[2]) - sqr(radius);
+	if((tile->step < PROGRESSIVE_BLOCK) && (tile->job->deadline > 0) && (raycaster_now() >= tile->job->deadline)) {
+		tile->done = 0;
+		return;
 
-	discriminant  = sqr(b) - 4 * a * c;
-	
-	if(discriminant < 0) {
-		// Has no solution
-		return (-1);
-		
 	}
 
-	// Quadratic formula
-	t1 = (-1 * b + sqrt(sqr(b) - 4 * a * c)) / (2 * a);
-	t0 = (-1 * b - sqrt(sqr(b) - 4 * a * c)) / (2 * a);
-	
-	if(t0 >= 0){
-		return t0;
-		
-	} else if(t1 >= 0){
-		return t1;
-		
+	if(stats_enabled()) {
+		memset(&counters, 0, sizeof(RenderStats));
+		refine_pixels(tile->job, tile->x0, tile->y0, tile->x1, tile->y1, tile->step, &counters);
+		stats_merge(&counters);
+
 	} else {
-		return (-1);
-		
+		refine_pixels(tile->job, tile->x0, tile->y0, tile->x1, tile->y1, tile->step, NULL);
+
 	}
 
+	tile->done = 1;
+
 }
 
 
 /**
- * plane_intersection
+ * smooth_tile
  *
- * @param ro - ray vector orgin
- * @param rd - ray vector direction
- * @param pos - position
- * @param normal - the orthogonal normal vector to the plane
- * @returns double percision float t value that represents length of the intersecting vector, and -1 if
- * no intersection was detected.
- * @description this function detects the distance a ray vector intersects the plane
+ * @param arg - Tile to antialias
+ * @returns void
+ * @description thread pool task wrapper around smooth_pixels
  */
-double plane_intersection(double *ro, double *rd, double *pos, double *normal){
-	// normal defines the orientation of the plane
-	// the property that the dot product of two perpendicular vectors is equal to 0
-	// p0 = plane position
-	// (p - p0) * normal = 0
-	// p = ro + rd + t
-	// (ro + rd * t - p0) * normal = 0
-	// ((ppos - ro) * normal) / (rd * normal) <- Dot product - a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
-	double numerator, denominator, t;
-	
-	normalize(normal);
+static void smooth_tile(void *arg) {
+	Tile *tile = (Tile *)arg;
+	RenderStats counters;
+
+	if(stats_enabled()) {
+		memset(&counters, 0, sizeof(RenderStats));
+		tile->edges = smooth_pixels(tile->job, tile->x0, tile->y0, tile->x1, tile->y1, &counters);
+		stats_merge(&counters);
 
-	numerator = (normal[0] * (pos[0] - ro[0])) + (normal[1] * (pos[1] - ro[1])) + (normal[2] * (pos[2] - ro[2])); 
-	denominator = (normal[0] * rd[0]) + (normal[1] * rd[1]) + (normal[2] * rd[2]);
-	
-	t = numerator / denominator;
-	
-	if(t >= 0) {
-		return t;
-		
 	} else {
-		return (-1);
-		
+		tile->edges = smooth_pixels(tile->job, tile->x0, tile->y0, tile->x1, tile->y1, NULL);
+
 	}
-	
+
 }
 
 
 /**
- * raycaster
+ * prepare_job
  *
- * @param objects[] - collection of objects read in from the json parser
- * @param image - is an Image object used to store image data
- * @param num_objects - number of objects read in from the json parser use to set
- * iteration values for, for loops.
- * @returns Image - which is the image pointer to the image object that is used to store
- * the image data for write purposes.
- * @description this function implements the raycasting portion of this application it performs
- * the calculations for pixel scaling, and logic that uses the scene data to detect object ray
- * intersections, colors pixels related to the object data, and stores the collection of information
- * into an image data buffer to be written using a ppm write function.
+ * @param job - render job to fill in
+ * @param scene - render scene
+ * @param image - image being rendered, only its width and height are used here
+ * @returns void
+ * @description derives the pixel scaling from the scene's camera, exits when there is no camera,
+ * when the scene was not prepared with scene_prepare, or when it was binned for another image size
  */
-Image* raycaster(Object objects[], Image *image, int num_objects) {
-	double pixel_height, pixel_width;
-	double cx, cy;
-	double h, w;
-	double t, best_t;
-	double red, green, blue;
-	int row, column, index, t_object;
-	double rd[3];
+static void prepare_job(RenderJob *job, RenderScene *scene, Image *image) {
+	if(scene->prepared == 0) {
+		fprintf(stderr, "Error, the scene must be prepared before it is rendered.\n");
+		exit(-1);
+
+	}
+
+	if((scene->bins != NULL) && ((scene->bins->width != image->width) || (scene->bins->height != image->height))) {
+		fprintf(stderr, "Error, the scene was binned for another image size.\n");
+		exit(-1);
+
+	}
+
+	job->scene = scene;
+	job->image = image;
+	job->first_row = 0;
+	job->deadline = 0;
+	job->ids = NULL;
+	job->samples = 1;
 
-	// Set ray orgin
-	double ro[3] = {0, 0, 0};
-	
 	// Set center x & y
-	cx = 0;
-	cy = 0;
+	job->cx = 0;
+	job->cy = 0;
 	
 	// Check scene for a camera
-	index = get_camera(objects, num_objects);
-	
-	if(index == (-1)){
+	if(scene->has_camera == 0){
 		// Missing camera
 		fprintf(stderr, "Error, no camera object was found.\n");
 		exit(-1);
 		
 	} else {
 		// Get camera height and width
-		h = objects[index].properties.camera.height;
-		w = objects[index].properties.camera.width;
+		job->h = scene->camera_height;
+		job->w = scene->camera_width;
 		
 		// Scale pixels
-		pixel_height = h / (image->height);
-		pixel_width = w / (image->width);
+		job->pixel_height = job->h / (image->height);
+		job->pixel_width = job->w / (image->width);
 		
 	}
 
-	for(row = 0; row < (image->height); row++) {
-		
-		for(column = 0; column < (image->width); column++) {
+}
+
+
+/**
+ * render_rows
+ *
+ * @param job - render job
+ * @param pool - thread pool rendering the tiles, NULL renders on the calling thread
+ * @param tiles - storage for one tile per TILE_SIZE square of the rows
+ * @param y0 - first row
+ * @param y1 - one past the last row
+ * @returns void
+ * @description renders rows [y0, y1) of the image and waits until they are done
+ */
+static void render_rows(RenderJob *job, ThreadPool *pool, Tile *tiles, int y0, int y1) {
+	int width = job->image->width;
+	int index, x, y;
+
+	if(pool == NULL) {
+		render_region(job, 0, y0, width, y1);
+		return;
+
+	}
+
+	// Queue tiles row by row, neighbouring tiles land on different workers
+	index = 0;
+
+	for(y = y0; y < y1; y += TILE_SIZE) {
+		for(x = 0; x < width; x += TILE_SIZE) {
+			tiles[index].job = job;
+			tiles[index].x0 = x;
+			tiles[index].y0 = y;
+			tiles[index].x1 = (x + TILE_SIZE < width) ? x + TILE_SIZE : width;
+			tiles[index].y1 = (y + TILE_SIZE < y1) ? y + TILE_SIZE : y1;
+			threadpool_submit(pool, render_tile, &tiles[index]);
+			index = index + 1;
+
+		}
+
+	}
+
+	threadpool_wait(pool);
+
+}
+
+
+/**
+ * allocate_tiles
+ *
+ * @param image - image being rendered
+ * @param rows - rows rendered at once
+ * @returns storage for the tiles covering rows rows of the image
+ * @description allocates the tile array used by render_rows
+ */
+static Tile *allocate_tiles(Image *image, int rows) {
+	Tile *tiles;
+
+	tiles = malloc(sizeof(Tile) * ((image->width + TILE_SIZE - 1) / TILE_SIZE) * ((rows + TILE_SIZE - 1) / TILE_SIZE));
+
+	if(tiles == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	return tiles;
+
+}
+
+
+/**
+ * raycaster
+ *
+ * @param scene - render scene built from the objects read in by the json parser
+ * @param image - is an Image object used to store image data
+ * @param pool - thread pool rendering the tiles, NULL renders on the calling thread
+ * @returns Image - which is the image pointer to the image object that is used to store
+ * the image data for write purposes.
+ * @description this function implements the raycasting portion of this application it performs
+ * the calculations for pixel scaling, and logic that uses the scene data to detect object ray
+ * intersections, colors pixels related to the object data, and stores the collection of information
+ * into an image data buffer to be written using a ppm write function. With a thread pool the
+ * image is split into TILE_SIZE square tiles which are scheduled over a work stealing thread pool,
+ * each pixel is computed exactly as it is on a single thread so the output is identical.
+ */
+Image* raycaster(RenderScene *scene, Image *image, ThreadPool *pool) {
+	RenderJob job;
+	Tile *tiles;
+
+	prepare_job(&job, scene, image);
+
+	if(pool == NULL) {
+		render_rows(&job, NULL, NULL, 0, image->height);
+		return image;
+
+	}
+
+	tiles = allocate_tiles(image, image->height);
+	render_rows(&job, pool, tiles, 0, image->height);
+	free(tiles);
+
+	return image;
 	
-			rd[0] = (cx - (w / 2.0) + pixel_width * (column + 0.5));
-			rd[1] = - 1 * (cy - (h / 2.0) + pixel_height * (row + 0.5));
-			rd[2] = 1.0;
-			
-			// Normalize ray direction
-			normalize(rd);
-			best_t = INFINITY;
-			
-			for(index = 0; index < num_objects; index++) {
-				t = 0;
-				
-				if((objects[index].type) != NULL) {
-					if(strcmp((objects[index].type), "sphere") == 0){
-						t = sphere_intersection(ro, rd, objects[index].properties.sphere.position, objects[index].properties.sphere.radius);
-						//printf("Best t - sphere: %lf\n", t);
-						//printf("Position: %lf %lf %lf\n\n", objects[index].properties.sphere.position[0], objects[index].properties.sphere.position[1], objects[index].properties.sphere.position[2]);
-					
-					} else if(strcmp((objects[index].type), "plane") == 0) {
-						t = plane_intersection(ro, rd, objects[index].properties.plane.position, objects[index].properties.plane.normal);
-						//printf("Best t - plane: %lf\n", t);
-						//printf("Position: %lf %lf %lf\n\n", objects[index].properties.plane.position[0], objects[index].properties.plane.position[1], objects[index].properties.plane.position[2]);
-				
-					}
-					
-					// Get the best t value and object index
-					if ((t > 0) && (t < best_t)){
-						best_t = t;
-						t_object = index;
-					
-					}
-					
-				}
-				
-				
-			} // EoObject iteration loop
-			
-			if((best_t > 0) && (best_t != INFINITY)){
-				
-				if(strcmp(objects[t_object].type, "sphere") == 0) {
-					red = objects[t_object].properties.sphere.color[0] * (image->max_color);
-					image->image_data[(image->width) * row + column].red = red;
-					
-					green = objects[t_object].properties.sphere.color[1] * (image->max_color);
-					image->image_data[(image->width) * row + column].green = green;
-					
-					blue = objects[t_object].properties.sphere.color[2] * (image->max_color);
-					image->image_data[(image->width) * row + column].blue = blue;
-				
-				} else if(strcmp(objects[t_object].type, "plane") == 0){
-					red = objects[t_object].properties.plane.color[0] * (image->max_color);
-					image->image_data[(image->width) * row + column].red = red;
-					
-					green = objects[t_object].properties.plane.color[1] * (image->max_color);
-					image->image_data[(image->width) * row + column].green = green;
-					
-					blue = objects[t_object].properties.plane.color[2] * (image->max_color);
-					image->image_data[(image->width) * row + column].blue = blue;
-					
+}
+
+
+/**
+ * raycaster_stream
+ *
+ * @param scene - render scene built from the objects read in by the json parser
+ * @param image - width, height, and maximum color of the image, image_data is not used
+ * @param pool - thread pool rendering the tiles, NULL renders on the calling thread
+ * @param stream - P6 stream opened with band_rows of BAND_ROWS
+ * @returns void
+ * @description renders the image one band of BAND_ROWS rows at a time into the stream's band
+ * buffers. While the stream's writer thread writes a band out the next bands are rendered, and
+ * only the stream's few band buffers are held in memory instead of the whole image. Pixels are
+ * computed exactly as raycaster computes them.
+ */
+void raycaster_stream(RenderScene *scene, Image *image, ThreadPool *pool, PpmStream *stream) {
+	RenderJob job;
+	Image band_image;
+	PpmBand *band;
+	Tile *tiles;
+	int y0, y1;
+
+	prepare_job(&job, scene, image);
+
+	band_image = *image;
+	job.image = &band_image;
+	tiles = (pool != NULL) ? allocate_tiles(image, BAND_ROWS) : NULL;
+
+	for(y0 = 0; y0 < image->height; y0 = y1) {
+		y1 = (y0 + BAND_ROWS < image->height) ? y0 + BAND_ROWS : image->height;
+
+		// Rows without a hit stay black
+		band = ppm_stream_band(stream);
+		band->rows = y1 - y0;
+		memset(band->pixels, 0, sizeof(Pixel) * image->width * band->rows);
+
+		band_image.image_data = band->pixels;
+		job.first_row = y0;
+		render_rows(&job, pool, tiles, y0, y1);
+
+		ppm_stream_submit(stream, band);
+
+	}
+
+	free(tiles);
+
+}
+
+
+/**
+ * raycaster_progressive
+ *
+ * @param scene - render scene built from the objects read in by the json parser
+ * @param image - is an Image object used to store image data
+ * @param pool - thread pool refining the tiles, NULL renders on the calling thread
+ * @param budget_ms - milliseconds the render may take, 0 refines down to single pixels
+ * @returns the block size of the finest pass that covered the whole image, 1 when the image is
+ * fully rendered
+ * @description renders coarse to fine instead of top to bottom. The first pass traces one ray per
+ * PROGRESSIVE_BLOCK square block and fills each block with its color, every later pass halves the
+ * block size until every pixel is traced. Passes are split into TILE_SIZE square tiles; once the
+ * budget is spent no further tile is refined and the image holds the best pass each tile reached.
+ * The first pass always completes, and a render that is not cut short is identical to raycaster's
+ * on a zeroed image.
+ */
+int raycaster_progressive(RenderScene *scene, Image *image, ThreadPool *pool, double budget_ms) {
+	RenderJob job;
+	Tile *tiles;
+	int num_tiles, index, step, finest, x, y;
+
+	prepare_job(&job, scene, image);
+	job.deadline = (budget_ms > 0) ? raycaster_now() + budget_ms : 0;
+
+	tiles = allocate_tiles(image, image->height);
+	finest = PROGRESSIVE_BLOCK;
+
+	for(step = PROGRESSIVE_BLOCK; step >= 1; step = step / 2) {
+		num_tiles = 0;
+
+		for(y = 0; y < image->height; y += TILE_SIZE) {
+			for(x = 0; x < image->width; x += TILE_SIZE) {
+				tiles[num_tiles].job = &job;
+				tiles[num_tiles].x0 = x;
+				tiles[num_tiles].y0 = y;
+				tiles[num_tiles].x1 = (x + TILE_SIZE < image->width) ? x + TILE_SIZE : image->width;
+				tiles[num_tiles].y1 = (y + TILE_SIZE < image->height) ? y + TILE_SIZE : image->height;
+				tiles[num_tiles].step = step;
+
+				if(pool != NULL) {
+					threadpool_submit(pool, refine_tile, &tiles[num_tiles]);
+
+				} else {
+					refine_tile(&tiles[num_tiles]);
+
 				}
-				
+
+				num_tiles = num_tiles + 1;
+
 			}
-			
-		} // EoRow Loop
-		
-	} // EoColumn Loop 
 
-	return image;
-	
-}
\ No newline at end of file
+		}
+
+		if(pool != NULL) {
+			threadpool_wait(pool);
+
+		}
+
+		for(index = 0; (index < num_tiles) && (tiles[index].done); index++);
+
+		if(index < num_tiles) {
+			break;
+
+		}
+
+		finest = step;
+
+	}
+
+	free(tiles);
+
+	return finest;
+
+}
+
+
+/**
+ * raycaster_antialias
+ *
+ * @param scene - render scene built from the objects read in by the json parser
+ * @param image - is an Image object used to store image data
+ * @param pool - thread pool rendering the tiles, NULL renders on the calling thread
+ * @param samples - rays per axis in an edge pixel, samples x samples rays in all
+ * @returns number of pixels supersampled
+ * @description renders an antialiased image in two passes. The first pass is raycaster's, one ray
+ * per pixel, and records which object each ray hit. The second pass supersamples only the pixels
+ * on an edge between objects, or between an object and the background, see smooth_pixels. Since
+ * shading is flat every other pixel would average samples of one color, so the image matches
+ * uniform supersampling apart from objects too thin to reach any pixel's center.
+ */
+int raycaster_antialias(RenderScene *scene, Image *image, ThreadPool *pool, int samples) {
+	RenderJob job;
+	Tile *tiles;
+	int num_tiles, index, edges, x, y;
+
+	prepare_job(&job, scene, image);
+	job.samples = samples;
+	job.ids = malloc(sizeof(int) * image->width * image->height);
+	tiles = allocate_tiles(image, image->height);
+
+	if(job.ids == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	render_rows(&job, pool, tiles, 0, image->height);
+
+	// Every id is known once the first pass is done, neighbouring tiles may be smoothed at once
+	num_tiles = 0;
+
+	for(y = 0; y < image->height; y += TILE_SIZE) {
+		for(x = 0; x < image->width; x += TILE_SIZE) {
+			tiles[num_tiles].job = &job;
+			tiles[num_tiles].x0 = x;
+			tiles[num_tiles].y0 = y;
+			tiles[num_tiles].x1 = (x + TILE_SIZE < image->width) ? x + TILE_SIZE : image->width;
+			tiles[num_tiles].y1 = (y + TILE_SIZE < image->height) ? y + TILE_SIZE : image->height;
+
+			if(pool != NULL) {
+				threadpool_submit(pool, smooth_tile, &tiles[num_tiles]);
+
+			} else {
+				smooth_tile(&tiles[num_tiles]);
+
+			}
+
+			num_tiles = num_tiles + 1;
+
+		}
+
+	}
+
+	if(pool != NULL) {
+		threadpool_wait(pool);
+
+	}
+
+	edges = 0;
+
+	for(index = 0; index < num_tiles; index++) {
+		edges = edges + tiles[index].edges;
+
+	}
+
+	free(tiles);
+	free(job.ids);
+
+	return edges;
+
+}
@@ -9,7 +9,27 @@
 #ifndef raycaster_h
 #define raycaster_h
 
+// Width and height in pixels of the tiles handed to render threads
+#define TILE_SIZE 32
+
+// Rows in one band of a streamed render, a whole row of tiles
+#define BAND_ROWS TILE_SIZE
+
+// Band buffers of a streamed render, one being written while the others are rendered
+#define BAND_BUFFERS 4
+
+// Block size of the first pass of a progressive render, divides TILE_SIZE
+#define PROGRESSIVE_BLOCK 16
+
+// Most rays per axis of an antialiased edge pixel
+#define ANTIALIAS_MAX_SAMPLES 8
+
 // function declarations
-Image* raycaster(Object objects[], Image *image, int num_objects);
+double sphere_intersection(double *ro, double *rd, double *center, double radius);
+double plane_intersection(double *ro, double *rd, double *pos, double *normal);
+Image* raycaster(RenderScene *scene, Image *image, ThreadPool *pool);
+void raycaster_stream(RenderScene *scene, Image *image, ThreadPool *pool, PpmStream *stream);
+int raycaster_progressive(RenderScene *scene, Image *image, ThreadPool *pool, double budget_ms);
+int raycaster_antialias(RenderScene *scene, Image *image, ThreadPool *pool, int samples);
  
 #endif
\ No newline at end of file
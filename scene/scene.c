@@ -0,0 +1,892 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: scene.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <sys/mman.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\threadpool\threadpool.h"
+#include "..\simd\simd.h"
+#include "scene.h"
+#include "..\bvh\bvh.h"
+#include "..\tilebin\tilebin.h"
+#include "..\binscene\binscene.h"
+#include "..\stats\stats.h"
+
+/**
+ * SceneStream
+ *
+ * @description a json scene being streamed into a render scene by scene_load
+ */
+typedef struct SceneStream {
+	RenderScene *scene;
+	ObjectHandler display;
+
+} SceneStream;
+
+
+/**
+ * object_kind
+ *
+ * @param type - type string read in from the json parser, may be NULL
+ * @returns the ObjectKind matching the type string, KIND_UNKNOWN otherwise
+ * @description resolves an object's type string to its integer tag
+ */
+ObjectKind object_kind(const char *type) {
+	if(type == NULL) {
+		return(KIND_UNKNOWN);
+
+	} else if(strcmp(type, "sphere") == 0) {
+		return(KIND_SPHERE);
+
+	} else if(strcmp(type, "plane") == 0) {
+		return(KIND_PLANE);
+
+	} else if(strcmp(type, "camera") == 0) {
+		return(KIND_CAMERA);
+
+	}
+
+	return(KIND_UNKNOWN);
+
+}
+
+
+/**
+ * scene_column
+ *
+ * @param column - column to resize, may be NULL
+ * @param count - number of elements
+ * @param size - size of one element
+ * @returns pointer to the resized column, never NULL
+ * @description grows or shrinks one structure of arrays column, keeping its contents
+ */
+static void *scene_column(void *column, int count, size_t size) {
+	column = realloc(column, size * (count > 0 ? count : 1));
+
+	if(column == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	return column;
+
+}
+
+
+/**
+ * scene_reserve
+ *
+ * @param scene - render scene
+ * @param spheres - number of spheres the columns must hold
+ * @param planes - number of planes the columns must hold
+ * @returns void
+ * @description resizes the sphere and plane columns to the given capacities, a compact scene's
+ * spheres live in its single precision geometry and palette indices
+ */
+static void scene_reserve(RenderScene *scene, int spheres, int planes) {
+	if((spheres != scene->max_spheres) && (scene->compact)) {
+		scene->single->sphere_x = scene_column(scene->single->sphere_x, spheres, sizeof(float));
+		scene->single->sphere_y = scene_column(scene->single->sphere_y, spheres, sizeof(float));
+		scene->single->sphere_z = scene_column(scene->single->sphere_z, spheres, sizeof(float));
+		scene->single->sphere_radius = scene_column(scene->single->sphere_radius, spheres, sizeof(float));
+		scene->sphere_color = scene_column(scene->sphere_color, spheres, sizeof(unsigned int));
+		scene->sphere_order = scene_column(scene->sphere_order, spheres, sizeof(int));
+		scene->max_spheres = spheres;
+
+	} else if(spheres != scene->max_spheres) {
+		scene->sphere_x = scene_column(scene->sphere_x, spheres, sizeof(double));
+		scene->sphere_y = scene_column(scene->sphere_y, spheres, sizeof(double));
+		scene->sphere_z = scene_column(scene->sphere_z, spheres, sizeof(double));
+		scene->sphere_radius = scene_column(scene->sphere_radius, spheres, sizeof(double));
+		scene->sphere_red = scene_column(scene->sphere_red, spheres, sizeof(double));
+		scene->sphere_green = scene_column(scene->sphere_green, spheres, sizeof(double));
+		scene->sphere_blue = scene_column(scene->sphere_blue, spheres, sizeof(double));
+		scene->sphere_order = scene_column(scene->sphere_order, spheres, sizeof(int));
+		scene->max_spheres = spheres;
+
+	}
+
+	if(planes != scene->max_planes) {
+		scene->plane_x = scene_column(scene->plane_x, planes, sizeof(double));
+		scene->plane_y = scene_column(scene->plane_y, planes, sizeof(double));
+		scene->plane_z = scene_column(scene->plane_z, planes, sizeof(double));
+		scene->plane_nx = scene_column(scene->plane_nx, planes, sizeof(double));
+		scene->plane_ny = scene_column(scene->plane_ny, planes, sizeof(double));
+		scene->plane_nz = scene_column(scene->plane_nz, planes, sizeof(double));
+		scene->plane_red = scene_column(scene->plane_red, planes, sizeof(double));
+		scene->plane_green = scene_column(scene->plane_green, planes, sizeof(double));
+		scene->plane_blue = scene_column(scene->plane_blue, planes, sizeof(double));
+		scene->plane_order = scene_column(scene->plane_order, planes, sizeof(int));
+		scene->max_planes = planes;
+
+	}
+
+}
+
+
+/**
+ * scene_allocate
+ *
+ * @param compact - 1 creates a compact scene
+ * @returns a newly allocated empty RenderScene
+ * @description creates an empty render scene whose columns are all valid
+ */
+static RenderScene *scene_allocate(int compact) {
+	RenderScene *scene;
+
+	scene = calloc(1, sizeof(RenderScene));
+
+	if(scene == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	if(compact) {
+		scene->compact = 1;
+		scene->single = calloc(1, sizeof(SingleScene));
+
+		if(scene->single == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	// Every column starts out valid, even before the first primitive is added
+	scene->max_spheres = -1;
+	scene->max_planes = -1;
+	scene_reserve(scene, 0, 0);
+
+	return scene;
+
+}
+
+
+/**
+ * scene_create
+ *
+ * @returns a newly allocated empty RenderScene
+ * @description creates a render scene that objects are added to one at a time with scene_add
+ */
+RenderScene *scene_create(void) {
+	return scene_allocate(0);
+
+}
+
+
+/**
+ * scene_create_compact
+ *
+ * @returns a newly allocated empty compact RenderScene
+ * @description creates a render scene that objects are added to one at a time with scene_add,
+ * keeping each sphere as a single precision center and radius and a palette index. A sphere takes
+ * 28 bytes once prepared, the prepared constant and tie breaking order included, where a double
+ * precision sphere takes 68. The scene always renders in single precision, it cannot be written
+ * to a binary scene file, animated, or rendered in double precision.
+ */
+RenderScene *scene_create_compact(void) {
+	return scene_allocate(1);
+
+}
+
+
+/**
+ * palette_hash
+ *
+ * @param color - red, green, and blue channels
+ * @returns hash of the channels' bits
+ * @description FNV-1a over the bytes of a color
+ */
+static unsigned int palette_hash(const double *color) {
+	const unsigned char *bytes = (const unsigned char *)color;
+	unsigned int hash;
+	int index;
+
+	hash = 2166136261u;
+
+	for(index = 0; index < (int)(3 * sizeof(double)); index++) {
+		hash = (hash ^ bytes[index]) * 16777619u;
+
+	}
+
+	return hash;
+
+}
+
+
+/**
+ * palette_index
+ *
+ * @param scene - compact render scene
+ * @param color - red, green, and blue channels of a sphere
+ * @returns index of the color in the scene's palette
+ * @description finds a color in the palette, appending it when it is new. The lookup table is
+ * kept at most half full, it is rebuilt twice as large from the palette when it fills up and
+ * rebuilt from scratch when scene_finish has released it.
+ */
+static unsigned int palette_index(RenderScene *scene, const double *color) {
+	unsigned int slot;
+	int index;
+
+	if(2 * (scene->num_colors + 1) > scene->num_slots) {
+		scene->num_slots = (scene->num_slots > 0) ? scene->num_slots * 2 : 64;
+
+		while(2 * (scene->num_colors + 1) > scene->num_slots) {
+			scene->num_slots = scene->num_slots * 2;
+
+		}
+
+		free(scene->palette_slots);
+		scene->palette_slots = scene_column(NULL, scene->num_slots, sizeof(int));
+		memset(scene->palette_slots, -1, sizeof(int) * scene->num_slots);
+
+		for(index = 0; index < scene->num_colors; index++) {
+			slot = palette_hash(&scene->palette[3 * index]) & (scene->num_slots - 1);
+
+			while(scene->palette_slots[slot] >= 0) {
+				slot = (slot + 1) & (scene->num_slots - 1);
+
+			}
+
+			scene->palette_slots[slot] = index;
+
+		}
+
+	}
+
+	slot = palette_hash(color) & (scene->num_slots - 1);
+
+	while((index = scene->palette_slots[slot]) >= 0) {
+		if(memcmp(&scene->palette[3 * index], color, sizeof(double) * 3) == 0) {
+			return(index);
+
+		}
+
+		slot = (slot + 1) & (scene->num_slots - 1);
+
+	}
+
+	if(scene->num_colors == scene->max_colors) {
+		scene->max_colors = (scene->max_colors > 0) ? scene->max_colors * 2 : 16;
+		scene->palette = scene_column(scene->palette, 3 * scene->max_colors, sizeof(double));
+
+	}
+
+	index = scene->num_colors;
+	memcpy(&scene->palette[3 * index], color, sizeof(double) * 3);
+	scene->palette_slots[slot] = index;
+	scene->num_colors = index + 1;
+
+	return(index);
+
+}
+
+
+/**
+ * scene_add
+ *
+ * @param scene - render scene
+ * @param object - object read in from the json parser
+ * @param index - position of the object in the scene, used to break ties between equal hits
+ * @returns void
+ * @description resolves the object's type, keeps the first camera, and appends spheres and planes
+ * to their structure of arrays columns, doubling a column's capacity when it is full. Plane
+ * normals are normalized on the copy, the object is left untouched. Objects must be added in
+ * scene order, and the scene prepared again before it is rendered.
+ */
+void scene_add(RenderScene *scene, Object *object, int index) {
+	ObjectKind kind;
+	double len;
+	int sphere, plane;
+
+	kind = object_kind(object->type);
+
+	// The prepared constants no longer cover every primitive
+	scene->prepared = 0;
+
+	if((kind == KIND_CAMERA) && (scene->has_camera == 0)) {
+		scene->has_camera = 1;
+		scene->camera_width = object->properties.camera.width;
+		scene->camera_height = object->properties.camera.height;
+
+	} else if(kind == KIND_SPHERE) {
+		if(scene->num_spheres == scene->max_spheres) {
+			scene_reserve(scene, (scene->max_spheres > 0) ? scene->max_spheres * 2 : 64, scene->max_planes);
+
+		}
+
+		sphere = scene->num_spheres;
+
+		if(scene->compact) {
+			scene->single->sphere_x[sphere] = (float)object->properties.sphere.position[0];
+			scene->single->sphere_y[sphere] = (float)object->properties.sphere.position[1];
+			scene->single->sphere_z[sphere] = (float)object->properties.sphere.position[2];
+			scene->single->sphere_radius[sphere] = (float)object->properties.sphere.radius;
+			scene->sphere_color[sphere] = palette_index(scene, object->properties.sphere.color);
+
+		} else {
+			scene->sphere_x[sphere] = object->properties.sphere.position[0];
+			scene->sphere_y[sphere] = object->properties.sphere.position[1];
+			scene->sphere_z[sphere] = object->properties.sphere.position[2];
+			scene->sphere_radius[sphere] = object->properties.sphere.radius;
+			scene->sphere_red[sphere] = object->properties.sphere.color[0];
+			scene->sphere_green[sphere] = object->properties.sphere.color[1];
+			scene->sphere_blue[sphere] = object->properties.sphere.color[2];
+
+		}
+
+		scene->sphere_order[sphere] = index;
+		scene->num_spheres = sphere + 1;
+
+	} else if(kind == KIND_PLANE) {
+		if(scene->num_planes == scene->max_planes) {
+			scene_reserve(scene, scene->max_spheres, (scene->max_planes > 0) ? scene->max_planes * 2 : 16);
+
+		}
+
+		plane = scene->num_planes;
+		scene->plane_x[plane] = object->properties.plane.position[0];
+		scene->plane_y[plane] = object->properties.plane.position[1];
+		scene->plane_z[plane] = object->properties.plane.position[2];
+
+		// Normalize the copy of the normal, divide each component by its magnitude
+		len = sqrt((object->properties.plane.normal[0] * object->properties.plane.normal[0]) +
+			(object->properties.plane.normal[1] * object->properties.plane.normal[1]) +
+			(object->properties.plane.normal[2] * object->properties.plane.normal[2]));
+		scene->plane_nx[plane] = object->properties.plane.normal[0] / len;
+		scene->plane_ny[plane] = object->properties.plane.normal[1] / len;
+		scene->plane_nz[plane] = object->properties.plane.normal[2] / len;
+
+		scene->plane_red[plane] = object->properties.plane.color[0];
+		scene->plane_green[plane] = object->properties.plane.color[1];
+		scene->plane_blue[plane] = object->properties.plane.color[2];
+		scene->plane_order[plane] = index;
+		scene->num_planes = plane + 1;
+
+	}
+
+}
+
+
+/**
+ * scene_finish
+ *
+ * @param scene - render scene
+ * @returns void
+ * @description trims the columns of a scene built with scene_add down to the primitives they hold,
+ * and a compact scene's palette down to its colors, its lookup table is released
+ */
+void scene_finish(RenderScene *scene) {
+	scene_reserve(scene, scene->num_spheres, scene->num_planes);
+
+	if(scene->compact) {
+		scene->palette = scene_column(scene->palette, 3 * scene->num_colors, sizeof(double));
+		scene->max_colors = scene->num_colors;
+		free(scene->palette_slots);
+		scene->palette_slots = NULL;
+		scene->num_slots = 0;
+
+	}
+
+}
+
+
+/**
+ * single_column
+ *
+ * @param column - double precision column
+ * @param count - number of elements
+ * @returns a newly allocated single precision copy of the column
+ * @description rounds every element of a column to the nearest float
+ */
+static float *single_column(const double *column, int count) {
+	float *single;
+	int index;
+
+	single = scene_column(NULL, count, sizeof(float));
+
+	for(index = 0; index < count; index++) {
+		single[index] = (float)column[index];
+
+	}
+
+	return single;
+
+}
+
+
+/**
+ * scene_prepare
+ *
+ * @param scene - render scene
+ * @param origin - origin every ray of the frame is cast from
+ * @returns void
+ * @description turns a scene into a render-ready scene. Every sphere and plane is checked for
+ * values that are not finite, which would also throw off the bounding volume hierarchy, then the
+ * parts of the ray equations that only depend on the ray origin are computed once per primitive:
+ * sphere_c holds |center - origin|^2 - radius^2 and plane_d holds normal . (position - origin).
+ * Plane normals were already normalized when the planes were added. A compact scene's constants
+ * go to its single precision geometry. A scene must be prepared again whenever its primitives or
+ * the ray origin change.
+ */
+void scene_prepare(RenderScene *scene, double *origin) {
+	SingleScene *single = scene->single;
+	int sphere, plane, finite;
+
+	for(sphere = 0; sphere < scene->num_spheres; sphere++) {
+		if(scene->compact) {
+			finite = isfinite(single->sphere_x[sphere]) && isfinite(single->sphere_y[sphere]) &&
+				isfinite(single->sphere_z[sphere]) && isfinite(single->sphere_radius[sphere]);
+
+		} else {
+			finite = isfinite(scene->sphere_x[sphere]) && isfinite(scene->sphere_y[sphere]) &&
+				isfinite(scene->sphere_z[sphere]) && isfinite(scene->sphere_radius[sphere]);
+
+		}
+
+		if(!finite) {
+			fprintf(stderr, "Error, object %d; sphere position and radius must be finite.\n", scene->sphere_order[sphere]);
+			exit(-1);
+
+		}
+
+	}
+
+	for(plane = 0; plane < scene->num_planes; plane++) {
+		if(!isfinite(scene->plane_x[plane]) || !isfinite(scene->plane_y[plane]) || !isfinite(scene->plane_z[plane])) {
+			fprintf(stderr, "Error, object %d; plane position must be finite.\n", scene->plane_order[plane]);
+			exit(-1);
+
+		}
+
+		// A zero length normal turns into not a number when it is normalized
+		if(!isfinite(scene->plane_nx[plane]) || !isfinite(scene->plane_ny[plane]) || !isfinite(scene->plane_nz[plane])) {
+			fprintf(stderr, "Error, object %d; plane normal must be finite and not zero length.\n", scene->plane_order[plane]);
+			exit(-1);
+
+		}
+
+	}
+
+	scene->plane_d = scene_column(scene->plane_d, scene->num_planes, sizeof(double));
+
+	if(scene->compact) {
+		// Computed in double precision from the stored floats, then rounded like scene_single does
+		single->sphere_c = scene_column(single->sphere_c, scene->num_spheres, sizeof(float));
+
+		for(sphere = 0; sphere < scene->num_spheres; sphere++) {
+			single->sphere_c[sphere] = (float)sphere_constant(origin, single->sphere_x[sphere], single->sphere_y[sphere], single->sphere_z[sphere], single->sphere_radius[sphere]);
+
+		}
+
+	} else {
+		scene->sphere_c = scene_column(scene->sphere_c, scene->num_spheres, sizeof(double));
+
+		for(sphere = 0; sphere < scene->num_spheres; sphere++) {
+			scene->sphere_c[sphere] = sphere_constant(origin, scene->sphere_x[sphere], scene->sphere_y[sphere], scene->sphere_z[sphere], scene->sphere_radius[sphere]);
+
+		}
+
+	}
+
+	for(plane = 0; plane < scene->num_planes; plane++) {
+		scene->plane_d[plane] = plane_constant(origin, scene->plane_x[plane], scene->plane_y[plane], scene->plane_z[plane],
+			scene->plane_nx[plane], scene->plane_ny[plane], scene->plane_nz[plane]);
+
+	}
+
+	if(scene->compact) {
+		// Planes are few, they keep their double precision columns and get a fresh single copy
+		free(single->plane_nx);
+		free(single->plane_ny);
+		free(single->plane_nz);
+		free(single->plane_d);
+		single->plane_nx = single_column(scene->plane_nx, scene->num_planes);
+		single->plane_ny = single_column(scene->plane_ny, scene->num_planes);
+		single->plane_nz = single_column(scene->plane_nz, scene->num_planes);
+		single->plane_d = single_column(scene->plane_d, scene->num_planes);
+
+	}
+
+	scene->origin[0] = origin[0];
+	scene->origin[1] = origin[1];
+	scene->origin[2] = origin[2];
+	scene->prepared = 1;
+
+}
+
+
+/**
+ * scene_single
+ *
+ * @param scene - prepared render scene, its bounding volume hierarchy must already be built
+ * @param release - 1 releases the double precision geometry once it is copied
+ * @returns void
+ * @description builds the single precision geometry the float32 render path intersects. With
+ * release the double precision geometry columns, prepared constants included, are released,
+ * which halves the geometry held in memory. Colors and orders are kept either way.
+ */
+void scene_single(RenderScene *scene, int release) {
+	SingleScene *single;
+
+	if(scene->single != NULL) {
+		return;
+
+	}
+
+	single = calloc(1, sizeof(SingleScene));
+
+	if(single == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	single->sphere_x = single_column(scene->sphere_x, scene->num_spheres);
+	single->sphere_y = single_column(scene->sphere_y, scene->num_spheres);
+	single->sphere_z = single_column(scene->sphere_z, scene->num_spheres);
+	single->sphere_c = single_column(scene->sphere_c, scene->num_spheres);
+	single->plane_nx = single_column(scene->plane_nx, scene->num_planes);
+	single->plane_ny = single_column(scene->plane_ny, scene->num_planes);
+	single->plane_nz = single_column(scene->plane_nz, scene->num_planes);
+	single->plane_d = single_column(scene->plane_d, scene->num_planes);
+	scene->single = single;
+
+	if(release) {
+		scene_column_free(scene, scene->sphere_x);
+		scene_column_free(scene, scene->sphere_y);
+		scene_column_free(scene, scene->sphere_z);
+		scene_column_free(scene, scene->sphere_radius);
+		scene_column_free(scene, scene->sphere_c);
+		scene_column_free(scene, scene->plane_x);
+		scene_column_free(scene, scene->plane_y);
+		scene_column_free(scene, scene->plane_z);
+		scene_column_free(scene, scene->plane_nx);
+		scene_column_free(scene, scene->plane_ny);
+		scene_column_free(scene, scene->plane_nz);
+		scene_column_free(scene, scene->plane_d);
+		scene->sphere_x = scene->sphere_y = scene->sphere_z = scene->sphere_radius = scene->sphere_c = NULL;
+		scene->plane_x = scene->plane_y = scene->plane_z = NULL;
+		scene->plane_nx = scene->plane_ny = scene->plane_nz = scene->plane_d = NULL;
+
+	}
+
+}
+
+
+/**
+ * scene_double
+ *
+ * @param scene - render scene
+ * @returns void
+ * @description releases the single precision geometry so the scene renders in double precision
+ * again, only valid while the double precision columns are kept and never for a compact scene
+ */
+void scene_double(RenderScene *scene) {
+	if(scene->single == NULL) {
+		return;
+
+	}
+
+	free(scene->single->sphere_x);
+	free(scene->single->sphere_y);
+	free(scene->single->sphere_z);
+	free(scene->single->sphere_radius);
+	free(scene->single->sphere_c);
+	free(scene->single->plane_nx);
+	free(scene->single->plane_ny);
+	free(scene->single->plane_nz);
+	free(scene->single->plane_d);
+	free(scene->single);
+	scene->single = NULL;
+
+}
+
+
+/**
+ * scene_build
+ *
+ * @param objects - scene of objects read in from the json parser
+ * @returns a newly allocated RenderScene
+ * @description counts the primitives so every column is allocated once, then adds the objects
+ * in scene order
+ */
+RenderScene *scene_build(Scene *objects) {
+	RenderScene *scene;
+	ObjectKind kind;
+	int index, spheres, planes;
+
+	scene = scene_create();
+	spheres = 0;
+	planes = 0;
+
+	// First pass, count primitives so every column is allocated once
+	for(index = 0; index < objects->num_objects; index++) {
+		kind = object_kind(scene_object(objects, index)->type);
+
+		if(kind == KIND_SPHERE) {
+			spheres = spheres + 1;
+
+		} else if(kind == KIND_PLANE) {
+			planes = planes + 1;
+
+		}
+
+	}
+
+	scene_reserve(scene, spheres, planes);
+
+	// Second pass, fill the columns in scene order
+	for(index = 0; index < objects->num_objects; index++) {
+		scene_add(scene, scene_object(objects, index), index);
+
+	}
+
+	return scene;
+
+}
+
+
+/**
+ * scene_column_free
+ *
+ * @param scene - render scene the column belongs to
+ * @param column - column to release, may be NULL
+ * @returns void
+ * @description releases a column unless it lives in the scene's binary scene file mapping
+ */
+void scene_column_free(RenderScene *scene, void *column) {
+	if((scene->mapping != NULL) && ((char *)column >= (char *)scene->mapping) &&
+		((char *)column < (char *)scene->mapping + scene->mapping_size)) {
+		return;
+
+	}
+
+	free(column);
+
+}
+
+
+/**
+ * scene_free
+ *
+ * @param scene - render scene created by scene_create, scene_create_compact, or scene_build, or
+ * loaded by binscene_load
+ * @returns void
+ * @description releases a render scene, its columns, its single precision geometry, its palette,
+ * its bounding volume hierarchy, its tile bins, and its binary scene file mapping
+ */
+void scene_free(RenderScene *scene) {
+	scene_double(scene);
+
+	if(scene->bins != NULL) {
+		tilebin_free(scene->bins);
+
+	}
+
+	if(scene->bvh != NULL) {
+		scene_column_free(scene, scene->bvh->nodes);
+		scene->bvh->nodes = NULL;
+		bvh_free(scene->bvh);
+
+	}
+
+	scene_column_free(scene, scene->sphere_x);
+	scene_column_free(scene, scene->sphere_y);
+	scene_column_free(scene, scene->sphere_z);
+	scene_column_free(scene, scene->sphere_radius);
+	scene_column_free(scene, scene->sphere_red);
+	scene_column_free(scene, scene->sphere_green);
+	scene_column_free(scene, scene->sphere_blue);
+	scene_column_free(scene, scene->sphere_order);
+	scene_column_free(scene, scene->sphere_c);
+	free(scene->sphere_color);
+	free(scene->palette);
+	free(scene->palette_slots);
+
+	scene_column_free(scene, scene->plane_x);
+	scene_column_free(scene, scene->plane_y);
+	scene_column_free(scene, scene->plane_z);
+	scene_column_free(scene, scene->plane_nx);
+	scene_column_free(scene, scene->plane_ny);
+	scene_column_free(scene, scene->plane_nz);
+	scene_column_free(scene, scene->plane_red);
+	scene_column_free(scene, scene->plane_green);
+	scene_column_free(scene, scene->plane_blue);
+	scene_column_free(scene, scene->plane_order);
+	scene_column_free(scene, scene->plane_d);
+
+	if(scene->mapping != NULL) {
+		munmap(scene->mapping, scene->mapping_size);
+
+	}
+
+	free(scene);
+
+}
+
+
+/**
+ * scene_stream_object
+ *
+ * @param object - object read in from the json parser, only valid during the call
+ * @param index - position of the object in the scene
+ * @param context - SceneStream
+ * @returns void
+ * @description ObjectHandler used by scene_load to stream a json scene, displays the object when
+ * asked to and adds it to the render scene
+ */
+static void scene_stream_object(Object *object, int index, void *context) {
+	SceneStream *stream = (SceneStream *)context;
+
+	if(stream->display != NULL) {
+		stream->display(object, index, NULL);
+
+	}
+
+	scene_add(stream->scene, object, index);
+
+}
+
+
+/**
+ * scene_load
+ *
+ * @param path - json or binary scene file, binary scene files are recognized by their contents
+ * @param options - how the scene is read and readied
+ * @param pool - thread pool building the hierarchy, NULL builds on the calling thread
+ * @param num_objects - receives the number of objects of the scene, 0 or less for an empty scene
+ * @returns the prepared render scene of the file
+ * @description reads a scene file and readies it for rendering the way every frontend does. The
+ * scene is prepared for rays from the origin, where the camera sits, then its hierarchy is built or dropped, then its
+ * single precision geometry is built, which releases the double precision columns after the
+ * hierarchy has reordered them. A bad scene file exits with its error message. The phases are
+ * timed for --stats.
+ */
+RenderScene *scene_load(const char *path, SceneOptions *options, struct ThreadPool *pool, int *num_objects) {
+	RenderScene *scene;
+	SceneStream stream;
+	Scene objects;
+	FILE *fpointer;
+	double origin[3] = {0.0, 0.0, 0.0};
+	int index, collected;
+
+	fpointer = fopen(path, "r");
+
+	if(fpointer == NULL) {
+		fprintf(stderr, "Error, could not open file.\n");
+		exit(-1);
+
+	}
+
+	collected = 0;
+	stats_start(PHASE_PARSE);
+
+	if(binscene_detect(fpointer)) {
+		// Precompiled scene, the render scene is mapped straight from the file
+		fclose(fpointer);
+		scene = binscene_load(path, num_objects);
+
+	} else if((options->stream_scene) || (options->compact)) {
+		// Objects go straight into the render scene, the parsed objects are never collected
+		stream.scene = (options->compact) ? scene_create_compact() : scene_create();
+		stream.display = options->display;
+
+		if(options->list != NULL) {
+			options->list(-1);
+
+		}
+
+		if(options->mmap_scene) {
+			fclose(fpointer);
+			*num_objects = json_stream_scene_mmap(path, scene_stream_object, &stream);
+
+		} else {
+			*num_objects = json_stream_scene(fpointer, scene_stream_object, &stream);
+			fclose(fpointer);
+
+		}
+
+		scene = stream.scene;
+		scene_finish(scene);
+
+	} else {
+		scene_init(&objects);
+		collected = 1;
+
+		if(options->mmap_scene) {
+			fclose(fpointer);
+			*num_objects = json_read_scene_mmap(path, &objects);
+
+		} else {
+			*num_objects = json_read_scene(fpointer, &objects);
+			fclose(fpointer);
+
+		}
+
+	}
+
+	stats_stop(PHASE_PARSE);
+
+	if(collected) {
+		if(options->list != NULL) {
+			options->list(*num_objects);
+
+		}
+
+		for(index = 0; (index < objects.num_objects) && (options->display != NULL); index++) {
+			options->display(scene_object(&objects, index), index, NULL);
+
+		}
+
+		// Resolve the parsed objects into the render side scene once, the render scene holds
+		// copies and the parsed objects are no longer needed
+		stats_start(PHASE_SCENE);
+		scene = scene_build(&objects);
+		scene_release(&objects);
+		stats_stop(PHASE_SCENE);
+
+	}
+
+	// Check the geometry and precompute the per-primitive ray constants, every ray starts at the
+	// camera in the origin. Done before the hierarchy is built so it never bins a sphere that is
+	// not finite.
+	stats_start(PHASE_SCENE);
+	scene_prepare(scene, origin);
+	stats_stop(PHASE_SCENE);
+
+	if((options->use_bvh) && (scene->bvh == NULL)) {
+		stats_start(PHASE_BVH);
+		scene->bvh = bvh_build(scene, pool);
+		stats_stop(PHASE_BVH);
+
+	} else if((options->use_bvh == 0) && (scene->bvh != NULL)) {
+		// Only binary scenes arrive with a hierarchy, its nodes live in the file mapping
+		free(scene->bvh);
+		scene->bvh = NULL;
+
+	}
+
+	if(options->single_precision) {
+		// Single precision geometry for the float32 kernels, built after the hierarchy
+		stats_start(PHASE_SCENE);
+		scene_single(scene, 1);
+		stats_stop(PHASE_SCENE);
+
+	}
+
+	return scene;
+
+}
@@ -0,0 +1,152 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: scene.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef scene_h
+#define scene_h
+
+#include <stddef.h>
+
+/**
+ * ObjectKind
+ *
+ * @description integer tag resolved once from an object's type string so the renderer never
+ * compares strings
+ */
+typedef enum ObjectKind {
+	KIND_UNKNOWN = 0,
+	KIND_CAMERA,
+	KIND_SPHERE,
+	KIND_PLANE
+
+} ObjectKind;
+
+
+/**
+ * SingleScene
+ *
+ * @description single precision copy of a render scene's prepared geometry for the float32
+ * render path, in the same structure of arrays order. Colors and tie breaking orders stay in the
+ * RenderScene. sphere_radius is only kept by compact scenes, whose spheres have no double
+ * precision columns to fall back on.
+ */
+typedef struct SingleScene {
+	float *sphere_x, *sphere_y, *sphere_z;
+	float *sphere_radius;
+	float *sphere_c;
+
+	float *plane_nx, *plane_ny, *plane_nz;
+	float *plane_d;
+
+} SingleScene;
+
+
+/**
+ * RenderScene
+ *
+ * @description render side copy of a scene. Spheres and planes are kept apart in structure of
+ * arrays form, each property in its own contiguous array, so the intersection loops stream
+ * through memory and can be vectorized. The order arrays hold each primitive's index in the
+ * original scene and are used to break ties between equally distant hits the same way a scan
+ * of the original object array does. bvh is the optional bounding volume hierarchy over the
+ * spheres, NULL when the spheres are scanned linearly. bins are the optional per screen tile
+ * sphere lists of one image size, used instead of the hierarchy when present. max_spheres and max_planes are the
+ * capacities of the columns while a scene is built up one object at a time. A scene loaded from a
+ * binary scene file keeps its columns in the file's memory mapping, mapping is NULL otherwise.
+ * single is the single precision geometry the renderer uses instead of the double columns, NULL
+ * unless a float32 render was asked for. A compact scene keeps its spheres in the single
+ * precision geometry alone, from the moment they are added, and their colors as an index into a
+ * palette of the scene's distinct colors, three doubles per color. Its double precision sphere
+ * columns stay NULL, palette_slots is the open addressing table that finds a color while the scene
+ * is built up. scene_prepare fills sphere_c and plane_d with the
+ * per-primitive constants of the ray equations for the frame's ray origin, rays are only cast
+ * from a prepared scene.
+ */
+typedef struct RenderScene {
+	int has_camera;
+	double camera_width, camera_height;
+
+	int num_spheres, max_spheres;
+	double *sphere_x, *sphere_y, *sphere_z;
+	double *sphere_radius;
+	double *sphere_red, *sphere_green, *sphere_blue;
+	int *sphere_order;
+	double *sphere_c;
+
+	int compact;
+	unsigned int *sphere_color;
+	int num_colors, max_colors;
+	double *palette;
+	int *palette_slots, num_slots;
+
+	int num_planes, max_planes;
+	double *plane_x, *plane_y, *plane_z;
+	double *plane_nx, *plane_ny, *plane_nz;
+	double *plane_red, *plane_green, *plane_blue;
+	int *plane_order;
+	double *plane_d;
+
+	int prepared;
+	double origin[3];
+
+	struct Bvh *bvh;
+	struct TileBins *bins;
+	SingleScene *single;
+
+	void *mapping;
+	size_t mapping_size;
+
+} RenderScene;
+
+/**
+ * ListHandler
+ *
+ * @description called by scene_load before it displays the objects of a json scene, with the
+ * number of objects of a collected scene, or -1 for a streamed scene whose objects are displayed
+ * before they are counted
+ */
+typedef void (*ListHandler)(int num_objects);
+
+
+/**
+ * SceneOptions
+ *
+ * @description how scene_load reads a scene file and readies it for rendering. use_bvh builds the
+ * bounding volume hierarchy, 0 also drops the one a binary scene file stores. single_precision
+ * builds the single precision geometry and releases the double precision columns. compact reads a
+ * json scene into a compact scene, see scene_create_compact. mmap_scene maps a json scene file
+ * into memory rather than reading it as a stream, stream_scene adds the objects of a json scene to
+ * the render scene as they are read rather than collecting them first, compact scenes are always
+ * streamed. list, when not NULL, is called once before the objects of a json scene are displayed.
+ * display, when not NULL, is called with every object of a json scene in scene order.
+ */
+typedef struct SceneOptions {
+	int use_bvh, single_precision, compact;
+	int mmap_scene, stream_scene;
+	ListHandler list;
+	ObjectHandler display;
+
+} SceneOptions;
+
+// Render threads of scene_load, declared in threadpool.h
+struct ThreadPool;
+
+// function declarations
+ObjectKind object_kind(const char *type);
+RenderScene *scene_create(void);
+RenderScene *scene_create_compact(void);
+void scene_add(RenderScene *scene, Object *object, int index);
+void scene_finish(RenderScene *scene);
+void scene_prepare(RenderScene *scene, double *origin);
+void scene_single(RenderScene *scene, int release);
+void scene_double(RenderScene *scene);
+RenderScene *scene_build(Scene *objects);
+void scene_column_free(RenderScene *scene, void *column);
+void scene_free(RenderScene *scene);
+RenderScene *scene_load(const char *path, SceneOptions *options, struct ThreadPool *pool, int *num_objects);
+
+#endif
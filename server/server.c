@@ -0,0 +1,512 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: server.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\ppm\ppm.h"
+#include "..\scene\scene.h"
+#include "..\simd\simd.h"
+#include "..\threadpool\threadpool.h"
+#include "..\bvh\bvh.h"
+#include "..\tilebin\tilebin.h"
+#include "..\raycaster\raycaster.h"
+#include "server.h"
+
+/**
+ * server_now
+ *
+ * @returns milliseconds on a monotonic clock
+ * @description times a job from its request to its reply
+ */
+static double server_now(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return(now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0);
+
+}
+
+
+/**
+ * server_listen
+ *
+ * @param socket_path - path of the Unix domain socket
+ * @returns the listening socket
+ * @description creates the socket the clients connect to. A socket left behind by a server that
+ * did not shut down is replaced, any other file at the path is an error.
+ */
+static int server_listen(const char *socket_path) {
+	struct sockaddr_un address;
+	struct stat status;
+	int listener;
+
+	if(strlen(socket_path) >= sizeof(address.sun_path)) {
+		fprintf(stderr, "Error, socket path is longer than %d characters.\n", (int)sizeof(address.sun_path) - 1);
+		exit(-1);
+
+	}
+
+	if(lstat(socket_path, &status) == 0) {
+		if(S_ISSOCK(status.st_mode) == 0) {
+			fprintf(stderr, "Error, '%s' exists and is not a socket.\n", socket_path);
+			exit(-1);
+
+		}
+
+		unlink(socket_path);
+
+	}
+
+	memset(&address, 0, sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path, socket_path);
+
+	listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+	if((listener < 0) || (bind(listener, (struct sockaddr *)&address, sizeof(address)) != 0) || (listen(listener, SERVER_BACKLOG) != 0)) {
+		fprintf(stderr, "Error, unable to listen on '%s'.\n", socket_path);
+		exit(-1);
+
+	}
+
+	return listener;
+
+}
+
+
+/**
+ * read_request
+ *
+ * @param client - connected client
+ * @param request - receives the request line without its line feed
+ * @returns 1 when a whole line was read, 0 otherwise
+ * @description reads one request line, a request is at most SERVER_REQUEST_SIZE bytes long
+ */
+static int read_request(int client, char *request) {
+	ssize_t count;
+	int length;
+
+	length = 0;
+
+	while(length < SERVER_REQUEST_SIZE - 1) {
+		count = read(client, request + length, 1);
+
+		if(count <= 0) {
+			return(0);
+
+		}
+
+		if(request[length] == '\n') {
+			request[length] = 0;
+			return(1);
+
+		}
+
+		length = length + 1;
+
+	}
+
+	return(0);
+
+}
+
+
+/**
+ * write_all
+ *
+ * @param client - connected client
+ * @param data - bytes to send
+ * @param length - number of bytes
+ * @returns 1 when everything was sent, 0 when the client went away
+ * @description sends a buffer, a socket may take it in several pieces
+ */
+static int write_all(int client, const void *data, size_t length) {
+	const char *bytes = data;
+	ssize_t count;
+
+	while(length > 0) {
+		count = write(client, bytes, length);
+
+		if(count <= 0) {
+			return(0);
+
+		}
+
+		bytes = bytes + count;
+		length = length - count;
+
+	}
+
+	return(1);
+
+}
+
+
+// Client of the job being run and the file its error messages are captured in, kept for
+// job_exit when a job exits the worker
+static int job_client = -1;
+static FILE *job_errors = NULL;
+
+/**
+ * reply_error
+ *
+ * @param client - connected client
+ * @returns void
+ * @description replies to a failed job with "ERR message", the error messages the job wrote to
+ * stderr joined on one line
+ */
+static void reply_error(int client) {
+	char message[SERVER_REQUEST_SIZE];
+	ssize_t count;
+	int index;
+
+	fflush(stderr);
+	lseek(fileno(job_errors), 0, SEEK_SET);
+	count = read(fileno(job_errors), message, SERVER_REQUEST_SIZE - 1);
+	count = (count > 0) ? count : 0;
+
+	while((count > 0) && ((message[count - 1] == '\n') || (message[count - 1] == ' '))) {
+		count = count - 1;
+
+	}
+
+	message[count] = 0;
+
+	for(index = 0; index < count; index++) {
+		if(message[index] == '\n') {
+			message[index] = ' ';
+
+		}
+
+	}
+
+	dprintf(client, "ERR %s\n", (count > 0) ? message : "Error, the job failed.");
+
+}
+
+
+/**
+ * job_exit
+ *
+ * @returns void
+ * @description exit handler of the worker, a job that exits the worker with one of raycast's
+ * errors still gets its ERR reply
+ */
+static void job_exit(void) {
+	if(job_client >= 0) {
+		reply_error(job_client);
+		job_client = -1;
+
+	}
+
+}
+
+
+/**
+ * load_scene
+ *
+ * @param cache - scene of the previous job
+ * @param path - scene file of the job
+ * @param options - server settings
+ * @param pool - thread pool building the hierarchy
+ * @returns the prepared render scene of the file, NULL for an empty scene
+ * @description reads a json or binary scene file with scene_load, or hands back the cached scene
+ * when the file has not changed since it was read. A bad scene file exits the worker with
+ * raycast's error message.
+ */
+static RenderScene *load_scene(ServerScene *cache, const char *path, ServerOptions *options, ThreadPool *pool) {
+	RenderScene *scene;
+	struct stat status;
+	int num_objects;
+
+	if(stat(path, &status) != 0) {
+		fprintf(stderr, "Error, could not open file.\n");
+		return(NULL);
+
+	}
+
+	if((cache->scene != NULL) && (strcmp(cache->path, path) == 0) && (cache->status.st_dev == status.st_dev) &&
+		(cache->status.st_ino == status.st_ino) && (cache->status.st_size == status.st_size) &&
+		(cache->status.st_mtim.tv_sec == status.st_mtim.tv_sec) && (cache->status.st_mtim.tv_nsec == status.st_mtim.tv_nsec)) {
+		return cache->scene;
+
+	}
+
+	if(cache->scene != NULL) {
+		scene_free(cache->scene);
+		cache->scene = NULL;
+
+	}
+
+	scene = scene_load(path, &options->scene, pool, &num_objects);
+
+	if(num_objects <= 0) {
+		scene_free(scene);
+		fprintf(stderr, "Error, the scene has no objects.\n");
+		return(NULL);
+
+	}
+
+	cache->scene = scene;
+	cache->num_objects = num_objects;
+	strcpy(cache->path, path);
+	cache->status = status;
+
+	return scene;
+
+}
+
+
+/**
+ * run_job
+ *
+ * @param client - connected client
+ * @param request - request line
+ * @param options - server settings
+ * @param pool - render thread pool, NULL renders on the worker thread
+ * @param image - framebuffer kept from job to job, grown when a job needs more pixels
+ * @param capacity - number of pixels the framebuffer holds
+ * @param cache - scene of the previous job
+ * @returns 1 when the job was rendered and its reply sent, 0 when it failed
+ * @description renders the image a request asks for and replies with its status, the image itself
+ * follows the reply when the output is -. The tile bins of the cached scene are rebuilt when the
+ * image size changes.
+ */
+static int run_job(int client, const char *request, ServerOptions *options, ThreadPool *pool, Image *image, int *capacity, ServerScene *cache) {
+	char input[SERVER_REQUEST_SIZE], output[SERVER_REQUEST_SIZE], extra[2], reply[SERVER_REQUEST_SIZE + 64];
+	RenderScene *scene;
+	double start;
+	int width, height, length;
+
+	start = server_now();
+
+	if((sscanf(request, "%d %d %4095s %4095s %1s", &width, &height, input, output, extra) != 4) ||
+		(width <= 0) || (height <= 0) || (width > SERVER_MAX_SIZE) || (height > SERVER_MAX_SIZE)) {
+		fprintf(stderr, "Error, expected a request of the form: width height input.json output.ppm.\n");
+		return(0);
+
+	}
+
+	scene = load_scene(cache, input, options, pool);
+
+	if(scene == NULL) {
+		return(0);
+
+	}
+
+	if((options->use_bins) && ((scene->bins == NULL) || (scene->bins->width != width) || (scene->bins->height != height))) {
+		if(scene->bins != NULL) {
+			tilebin_free(scene->bins);
+
+		}
+
+		scene->bins = tilebin_build(scene, width, height, TILE_SIZE);
+
+	}
+
+	if(width * height > *capacity) {
+		image->image_data = realloc(image->image_data, sizeof(Pixel) * width * height);
+
+		if(image->image_data == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		*capacity = width * height;
+
+	}
+
+	// Pixels without a hit are never written, the previous job must not show through
+	image->width = width;
+	image->height = height;
+	memset(image->image_data, 0, sizeof(Pixel) * width * height);
+	raycaster(scene, image, pool);
+
+	if(strcmp(output, "-") == 0) {
+		// The image goes back over the socket behind the reply
+		length = snprintf(reply, sizeof(reply), "P6\n%d %d\n%d\n", width, height, image->max_color);
+		dprintf(client, "OK %ld %.3f\n", (long)length + (long)sizeof(Pixel) * width * height, server_now() - start);
+		write_all(client, reply, length);
+		write_all(client, image->image_data, sizeof(Pixel) * width * height);
+
+	} else {
+		write_p6_image(output, image);
+		dprintf(client, "OK %s %.3f\n", output, server_now() - start);
+
+	}
+
+	return(1);
+
+}
+
+
+/**
+ * server_worker
+ *
+ * @param listener - listening socket
+ * @param options - server settings
+ * @returns void, returns once a client asks the server to quit
+ * @description serves jobs one at a time, each job is rendered by the whole thread pool. The pool,
+ * the framebuffer, and the last scene live as long as the worker. While a job runs its errors are
+ * captured and sent to the client behind ERR, an error that exits the worker takes down that job
+ * only.
+ */
+static void server_worker(int listener, ServerOptions *options) {
+	char request[SERVER_REQUEST_SIZE];
+	ServerScene cache;
+	ThreadPool *pool;
+	Image image;
+	int client, capacity, saved_stderr;
+
+	// A client that hangs up early must not take the worker with it
+	signal(SIGPIPE, SIG_IGN);
+
+	simd_select(options->simd_level);
+	pool = (options->num_threads > 1) ? threadpool_create(options->num_threads) : NULL;
+
+	memset(&cache, 0, sizeof(ServerScene));
+	memset(&image, 0, sizeof(Image));
+	image.max_color = 255;
+	capacity = 0;
+	saved_stderr = dup(STDERR_FILENO);
+	job_errors = tmpfile();
+
+	if(job_errors == NULL) {
+		fprintf(stderr, "Error, unable to capture the errors of render jobs.\n");
+		exit(-1);
+
+	}
+
+	atexit(job_exit);
+
+	for(;;) {
+		client = accept(listener, NULL, NULL);
+
+		if(client < 0) {
+			continue;
+
+		}
+
+		if(read_request(client, request) == 0) {
+			close(client);
+			continue;
+
+		}
+
+		if(strcmp(request, "QUIT") == 0) {
+			dprintf(client, "OK\n");
+			close(client);
+			break;
+
+		}
+
+		// Capture the job's error messages, they go back to the client behind ERR
+		fflush(stderr);
+		ftruncate(fileno(job_errors), 0);
+		lseek(fileno(job_errors), 0, SEEK_SET);
+		dup2(fileno(job_errors), STDERR_FILENO);
+		job_client = client;
+
+		if(run_job(client, request, options, pool, &image, &capacity, &cache) == 0) {
+			reply_error(client);
+
+		}
+
+		job_client = -1;
+		fflush(stderr);
+		dup2(saved_stderr, STDERR_FILENO);
+
+		printf("- JOB: %s -\n", request);
+		fflush(stdout);
+		close(client);
+
+	}
+
+	if(cache.scene != NULL) {
+		scene_free(cache.scene);
+
+	}
+
+	if(pool != NULL) {
+		threadpool_destroy(pool);
+
+	}
+
+	free(image.image_data);
+	fclose(job_errors);
+	close(saved_stderr);
+
+}
+
+
+/**
+ * server_run
+ *
+ * @param socket_path - path of the Unix domain socket to listen on
+ * @param options - render settings of every job
+ * @returns void, returns once a client sends QUIT
+ * @description runs raycast as a render server. Clients connect to the socket and send one
+ * request line, "width height input output", and get back one reply line, "OK output ms" once the
+ * image is written, or "ERR message" with raycast's error message when the job failed. A job that
+ * crashes the worker closes the connection without a reply. With an output of - the reply
+ * is "OK bytes ms" followed by the P6 image. The jobs are served by a worker process forked from
+ * this one, which is forked again whenever a job fails in a way that ends it.
+ */
+void server_run(const char *socket_path, ServerOptions *options) {
+	int listener, status;
+	pid_t worker;
+
+	listener = server_listen(socket_path);
+	printf("\n- LISTENING ON %s -\n", socket_path);
+	fflush(stdout);
+
+	for(;;) {
+		worker = fork();
+
+		if(worker < 0) {
+			fprintf(stderr, "Error, unable to start a render worker.\n");
+			exit(-1);
+
+		} else if(worker == 0) {
+			server_worker(listener, options);
+			exit(0);
+
+		}
+
+		if(waitpid(worker, &status, 0) < 0) {
+			fprintf(stderr, "Error, lost the render worker.\n");
+			exit(-1);
+
+		}
+
+		if(WIFEXITED(status) && (WEXITSTATUS(status) == 0)) {
+			break;
+
+		}
+
+		printf("- JOB FAILED, RESTARTING THE RENDER WORKER -\n");
+		fflush(stdout);
+
+	}
+
+	close(listener);
+	unlink(socket_path);
+
+}
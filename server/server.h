@@ -0,0 +1,56 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: server.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef server_h
+#define server_h
+
+#include <sys/stat.h>
+
+// Longest request line a client may send, the line feed included
+#define SERVER_REQUEST_SIZE 4096
+
+// Connections waiting for the worker before new clients are refused
+#define SERVER_BACKLOG 64
+
+// Largest width or height of a requested image
+#define SERVER_MAX_SIZE 16384
+
+/**
+ * ServerOptions
+ *
+ * @description render settings shared by every job, taken from the command line the server was
+ * started with. scene is how every job's scene file is read by scene_load, use_bins bins the
+ * spheres of every job's scene into screen tiles of the job's image size.
+ */
+typedef struct ServerOptions {
+	int num_threads;
+	SimdLevel simd_level;
+	int use_bins;
+	SceneOptions scene;
+
+} ServerOptions;
+
+
+/**
+ * ServerScene
+ *
+ * @description the render scene of the last job, prepared and with its bounding volume hierarchy.
+ * A job naming the same file, unchanged since it was read, renders it again without reading it.
+ */
+typedef struct ServerScene {
+	RenderScene *scene;
+	int num_objects;
+	char path[SERVER_REQUEST_SIZE];
+	struct stat status;
+
+} ServerScene;
+
+// function declarations
+void server_run(const char *socket_path, ServerOptions *options);
+
+#endif
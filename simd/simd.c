@@ -0,0 +1,709 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: simd.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "simd.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Packet kernels are built with floating point contraction disabled (see Makefile), every
+// lane performs the same operations in the same order as sphere_hit and plane_hit, or their
+// single precision versions, so the results are bit for bit identical to the scalar path.
+
+/**
+ * sphere_packet_scalar
+ *
+ * @description scalar fallback, one sphere_hit per sphere
+ */
+static void sphere_packet_scalar(double *ro, double *rd, const double *x, const double *y, const double *z, const double *constant, int count, double *t) {
+	int index;
+
+	for(index = 0; index < count; index++) {
+		t[index] = sphere_hit(ro, rd, x[index], y[index], z[index], constant[index]);
+
+	}
+
+}
+
+
+/**
+ * plane_packet_scalar
+ *
+ * @description scalar fallback, one plane_hit per plane
+ */
+static void plane_packet_scalar(double *rd, const double *nx, const double *ny, const double *nz, const double *constant, int count, double *t) {
+	int index;
+
+	for(index = 0; index < count; index++) {
+		t[index] = plane_hit(rd, nx[index], ny[index], nz[index], constant[index]);
+
+	}
+
+}
+
+
+/**
+ * sphere_packet_single_scalar
+ *
+ * @description scalar fallback, one sphere_hit_single per sphere
+ */
+static void sphere_packet_single_scalar(float *ro, float *rd, const float *x, const float *y, const float *z, const float *constant, int count, float *t) {
+	int index;
+
+	for(index = 0; index < count; index++) {
+		t[index] = sphere_hit_single(ro, rd, x[index], y[index], z[index], constant[index]);
+
+	}
+
+}
+
+
+/**
+ * plane_packet_single_scalar
+ *
+ * @description scalar fallback, one plane_hit_single per plane
+ */
+static void plane_packet_single_scalar(float *rd, const float *nx, const float *ny, const float *nz, const float *constant, int count, float *t) {
+	int index;
+
+	for(index = 0; index < count; index++) {
+		t[index] = plane_hit_single(rd, nx[index], ny[index], nz[index], constant[index]);
+
+	}
+
+}
+
+SpherePacket sphere_packet = sphere_packet_scalar;
+PlanePacket plane_packet = plane_packet_scalar;
+SpherePacketSingle sphere_packet_single = sphere_packet_single_scalar;
+PlanePacketSingle plane_packet_single = plane_packet_single_scalar;
+
+#ifdef SIMD_X86
+
+/**
+ * sphere_packet_sse2
+ *
+ * @description two spheres per step using SSE2, lanes are selected with and/andnot masks
+ */
+__attribute__((target("sse2")))
+static void sphere_packet_sse2(double *ro, double *rd, const double *x, const double *y, const double *z, const double *constant, int count, double *t) {
+	double a = (sqr(rd[0]) + sqr(rd[1]) + sqr(rd[2]));
+	__m128d ro0 = _mm_set1_pd(ro[0]), ro1 = _mm_set1_pd(ro[1]), ro2 = _mm_set1_pd(ro[2]);
+	__m128d rd0 = _mm_set1_pd(rd[0]), rd1 = _mm_set1_pd(rd[1]), rd2 = _mm_set1_pd(rd[2]);
+	__m128d two_a = _mm_set1_pd(2 * a), four_a = _mm_set1_pd(4 * a);
+	__m128d two = _mm_set1_pd(2), minus_one = _mm_set1_pd(-1), zero = _mm_setzero_pd();
+	__m128d dx, dy, dz, b, c, discriminant, root, nb, t0, t1, result, mask;
+	int index;
+
+	for(index = 0; index + 2 <= count; index += 2) {
+		dx = _mm_sub_pd(ro0, _mm_loadu_pd(x + index));
+		dy = _mm_sub_pd(ro1, _mm_loadu_pd(y + index));
+		dz = _mm_sub_pd(ro2, _mm_loadu_pd(z + index));
+		c = _mm_loadu_pd(constant + index);
+
+		b = _mm_mul_pd(two, _mm_add_pd(_mm_add_pd(_mm_mul_pd(rd0, dx), _mm_mul_pd(rd1, dy)), _mm_mul_pd(rd2, dz)));
+		discriminant = _mm_sub_pd(_mm_mul_pd(b, b), _mm_mul_pd(four_a, c));
+
+		// Skip the square root and divisions when every lane misses
+		if(_mm_movemask_pd(_mm_cmplt_pd(discriminant, zero)) == 0x3) {
+			_mm_storeu_pd(t + index, minus_one);
+			continue;
+
+		}
+
+		root = _mm_sqrt_pd(discriminant);
+		nb = _mm_mul_pd(minus_one, b);
+		t1 = _mm_div_pd(_mm_add_pd(nb, root), two_a);
+		t0 = _mm_div_pd(_mm_sub_pd(nb, root), two_a);
+
+		// Prefer t0, then t1, otherwise -1; no solution when the discriminant is negative
+		mask = _mm_cmpge_pd(t1, zero);
+		result = _mm_or_pd(_mm_and_pd(mask, t1), _mm_andnot_pd(mask, minus_one));
+		mask = _mm_cmpge_pd(t0, zero);
+		result = _mm_or_pd(_mm_and_pd(mask, t0), _mm_andnot_pd(mask, result));
+		mask = _mm_cmplt_pd(discriminant, zero);
+		result = _mm_or_pd(_mm_and_pd(mask, minus_one), _mm_andnot_pd(mask, result));
+
+		_mm_storeu_pd(t + index, result);
+
+	}
+
+	sphere_packet_scalar(ro, rd, x + index, y + index, z + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * plane_packet_sse2
+ *
+ * @description two planes per step using SSE2
+ */
+__attribute__((target("sse2")))
+static void plane_packet_sse2(double *rd, const double *nx, const double *ny, const double *nz, const double *constant, int count, double *t) {
+	__m128d rd0 = _mm_set1_pd(rd[0]), rd1 = _mm_set1_pd(rd[1]), rd2 = _mm_set1_pd(rd[2]);
+	__m128d minus_one = _mm_set1_pd(-1), zero = _mm_setzero_pd();
+	__m128d n0, n1, n2, denominator, result, mask;
+	int index;
+
+	for(index = 0; index + 2 <= count; index += 2) {
+		n0 = _mm_loadu_pd(nx + index);
+		n1 = _mm_loadu_pd(ny + index);
+		n2 = _mm_loadu_pd(nz + index);
+
+		denominator = _mm_add_pd(_mm_add_pd(_mm_mul_pd(n0, rd0), _mm_mul_pd(n1, rd1)), _mm_mul_pd(n2, rd2));
+		result = _mm_div_pd(_mm_loadu_pd(constant + index), denominator);
+
+		mask = _mm_cmpge_pd(result, zero);
+		result = _mm_or_pd(_mm_and_pd(mask, result), _mm_andnot_pd(mask, minus_one));
+
+		_mm_storeu_pd(t + index, result);
+
+	}
+
+	plane_packet_scalar(rd, nx + index, ny + index, nz + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * sphere_packet_avx2
+ *
+ * @description four spheres per step using AVX2
+ */
+__attribute__((target("avx2")))
+static void sphere_packet_avx2(double *ro, double *rd, const double *x, const double *y, const double *z, const double *constant, int count, double *t) {
+	double a = (sqr(rd[0]) + sqr(rd[1]) + sqr(rd[2]));
+	__m256d ro0 = _mm256_set1_pd(ro[0]), ro1 = _mm256_set1_pd(ro[1]), ro2 = _mm256_set1_pd(ro[2]);
+	__m256d rd0 = _mm256_set1_pd(rd[0]), rd1 = _mm256_set1_pd(rd[1]), rd2 = _mm256_set1_pd(rd[2]);
+	__m256d two_a = _mm256_set1_pd(2 * a), four_a = _mm256_set1_pd(4 * a);
+	__m256d two = _mm256_set1_pd(2), minus_one = _mm256_set1_pd(-1), zero = _mm256_setzero_pd();
+	__m256d dx, dy, dz, b, c, discriminant, root, nb, t0, t1, result;
+	int index;
+
+	for(index = 0; index + 4 <= count; index += 4) {
+		dx = _mm256_sub_pd(ro0, _mm256_loadu_pd(x + index));
+		dy = _mm256_sub_pd(ro1, _mm256_loadu_pd(y + index));
+		dz = _mm256_sub_pd(ro2, _mm256_loadu_pd(z + index));
+		c = _mm256_loadu_pd(constant + index);
+
+		b = _mm256_mul_pd(two, _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(rd0, dx), _mm256_mul_pd(rd1, dy)), _mm256_mul_pd(rd2, dz)));
+		discriminant = _mm256_sub_pd(_mm256_mul_pd(b, b), _mm256_mul_pd(four_a, c));
+
+		// Skip the square root and divisions when every lane misses
+		if(_mm256_movemask_pd(_mm256_cmp_pd(discriminant, zero, _CMP_LT_OQ)) == 0xf) {
+			_mm256_storeu_pd(t + index, minus_one);
+			continue;
+
+		}
+
+		root = _mm256_sqrt_pd(discriminant);
+		nb = _mm256_mul_pd(minus_one, b);
+		t1 = _mm256_div_pd(_mm256_add_pd(nb, root), two_a);
+		t0 = _mm256_div_pd(_mm256_sub_pd(nb, root), two_a);
+
+		// Prefer t0, then t1, otherwise -1; no solution when the discriminant is negative
+		result = _mm256_blendv_pd(minus_one, t1, _mm256_cmp_pd(t1, zero, _CMP_GE_OQ));
+		result = _mm256_blendv_pd(result, t0, _mm256_cmp_pd(t0, zero, _CMP_GE_OQ));
+		result = _mm256_blendv_pd(result, minus_one, _mm256_cmp_pd(discriminant, zero, _CMP_LT_OQ));
+
+		_mm256_storeu_pd(t + index, result);
+
+	}
+
+	sphere_packet_scalar(ro, rd, x + index, y + index, z + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * plane_packet_avx2
+ *
+ * @description four planes per step using AVX2
+ */
+__attribute__((target("avx2")))
+static void plane_packet_avx2(double *rd, const double *nx, const double *ny, const double *nz, const double *constant, int count, double *t) {
+	__m256d rd0 = _mm256_set1_pd(rd[0]), rd1 = _mm256_set1_pd(rd[1]), rd2 = _mm256_set1_pd(rd[2]);
+	__m256d minus_one = _mm256_set1_pd(-1), zero = _mm256_setzero_pd();
+	__m256d n0, n1, n2, denominator, result;
+	int index;
+
+	for(index = 0; index + 4 <= count; index += 4) {
+		n0 = _mm256_loadu_pd(nx + index);
+		n1 = _mm256_loadu_pd(ny + index);
+		n2 = _mm256_loadu_pd(nz + index);
+
+		denominator = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(n0, rd0), _mm256_mul_pd(n1, rd1)), _mm256_mul_pd(n2, rd2));
+		result = _mm256_div_pd(_mm256_loadu_pd(constant + index), denominator);
+		result = _mm256_blendv_pd(minus_one, result, _mm256_cmp_pd(result, zero, _CMP_GE_OQ));
+
+		_mm256_storeu_pd(t + index, result);
+
+	}
+
+	plane_packet_scalar(rd, nx + index, ny + index, nz + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * sphere_packet_avx512
+ *
+ * @description eight spheres per step using AVX-512, lanes are selected with mask registers
+ */
+__attribute__((target("avx512f")))
+static void sphere_packet_avx512(double *ro, double *rd, const double *x, const double *y, const double *z, const double *constant, int count, double *t) {
+	double a = (sqr(rd[0]) + sqr(rd[1]) + sqr(rd[2]));
+	__m512d ro0 = _mm512_set1_pd(ro[0]), ro1 = _mm512_set1_pd(ro[1]), ro2 = _mm512_set1_pd(ro[2]);
+	__m512d rd0 = _mm512_set1_pd(rd[0]), rd1 = _mm512_set1_pd(rd[1]), rd2 = _mm512_set1_pd(rd[2]);
+	__m512d two_a = _mm512_set1_pd(2 * a), four_a = _mm512_set1_pd(4 * a);
+	__m512d two = _mm512_set1_pd(2), minus_one = _mm512_set1_pd(-1), zero = _mm512_setzero_pd();
+	__m512d dx, dy, dz, b, c, discriminant, root, nb, t0, t1, result;
+	int index;
+
+	for(index = 0; index + 8 <= count; index += 8) {
+		dx = _mm512_sub_pd(ro0, _mm512_loadu_pd(x + index));
+		dy = _mm512_sub_pd(ro1, _mm512_loadu_pd(y + index));
+		dz = _mm512_sub_pd(ro2, _mm512_loadu_pd(z + index));
+		c = _mm512_loadu_pd(constant + index);
+
+		b = _mm512_mul_pd(two, _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(rd0, dx), _mm512_mul_pd(rd1, dy)), _mm512_mul_pd(rd2, dz)));
+		discriminant = _mm512_sub_pd(_mm512_mul_pd(b, b), _mm512_mul_pd(four_a, c));
+
+		// Skip the square root and divisions when every lane misses
+		if(_mm512_cmp_pd_mask(discriminant, zero, _CMP_LT_OQ) == 0xff) {
+			_mm512_storeu_pd(t + index, minus_one);
+			continue;
+
+		}
+
+		root = _mm512_sqrt_pd(discriminant);
+		nb = _mm512_mul_pd(minus_one, b);
+		t1 = _mm512_div_pd(_mm512_add_pd(nb, root), two_a);
+		t0 = _mm512_div_pd(_mm512_sub_pd(nb, root), two_a);
+
+		// Prefer t0, then t1, otherwise -1; no solution when the discriminant is negative
+		result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(t1, zero, _CMP_GE_OQ), minus_one, t1);
+		result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(t0, zero, _CMP_GE_OQ), result, t0);
+		result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(discriminant, zero, _CMP_LT_OQ), result, minus_one);
+
+		_mm512_storeu_pd(t + index, result);
+
+	}
+
+	sphere_packet_scalar(ro, rd, x + index, y + index, z + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * plane_packet_avx512
+ *
+ * @description eight planes per step using AVX-512
+ */
+__attribute__((target("avx512f")))
+static void plane_packet_avx512(double *rd, const double *nx, const double *ny, const double *nz, const double *constant, int count, double *t) {
+	__m512d rd0 = _mm512_set1_pd(rd[0]), rd1 = _mm512_set1_pd(rd[1]), rd2 = _mm512_set1_pd(rd[2]);
+	__m512d minus_one = _mm512_set1_pd(-1), zero = _mm512_setzero_pd();
+	__m512d n0, n1, n2, denominator, result;
+	int index;
+
+	for(index = 0; index + 8 <= count; index += 8) {
+		n0 = _mm512_loadu_pd(nx + index);
+		n1 = _mm512_loadu_pd(ny + index);
+		n2 = _mm512_loadu_pd(nz + index);
+
+		denominator = _mm512_add_pd(_mm512_add_pd(_mm512_mul_pd(n0, rd0), _mm512_mul_pd(n1, rd1)), _mm512_mul_pd(n2, rd2));
+		result = _mm512_div_pd(_mm512_loadu_pd(constant + index), denominator);
+		result = _mm512_mask_blend_pd(_mm512_cmp_pd_mask(result, zero, _CMP_GE_OQ), minus_one, result);
+
+		_mm512_storeu_pd(t + index, result);
+
+	}
+
+	plane_packet_scalar(rd, nx + index, ny + index, nz + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * sphere_packet_single_sse2
+ *
+ * @description four single precision spheres per step using SSE2
+ */
+__attribute__((target("sse2")))
+static void sphere_packet_single_sse2(float *ro, float *rd, const float *x, const float *y, const float *z, const float *constant, int count, float *t) {
+	float a = ((rd[0] * rd[0]) + (rd[1] * rd[1]) + (rd[2] * rd[2]));
+	__m128 ro0 = _mm_set1_ps(ro[0]), ro1 = _mm_set1_ps(ro[1]), ro2 = _mm_set1_ps(ro[2]);
+	__m128 rd0 = _mm_set1_ps(rd[0]), rd1 = _mm_set1_ps(rd[1]), rd2 = _mm_set1_ps(rd[2]);
+	__m128 two_a = _mm_set1_ps(2 * a), four_a = _mm_set1_ps(4 * a);
+	__m128 two = _mm_set1_ps(2), minus_one = _mm_set1_ps(-1), zero = _mm_setzero_ps();
+	__m128 dx, dy, dz, b, c, discriminant, root, nb, t0, t1, result, mask;
+	int index;
+
+	for(index = 0; index + 4 <= count; index += 4) {
+		dx = _mm_sub_ps(ro0, _mm_loadu_ps(x + index));
+		dy = _mm_sub_ps(ro1, _mm_loadu_ps(y + index));
+		dz = _mm_sub_ps(ro2, _mm_loadu_ps(z + index));
+		c = _mm_loadu_ps(constant + index);
+
+		b = _mm_mul_ps(two, _mm_add_ps(_mm_add_ps(_mm_mul_ps(rd0, dx), _mm_mul_ps(rd1, dy)), _mm_mul_ps(rd2, dz)));
+		discriminant = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(four_a, c));
+
+		// Skip the square root and divisions when every lane misses
+		if(_mm_movemask_ps(_mm_cmplt_ps(discriminant, zero)) == 0xf) {
+			_mm_storeu_ps(t + index, minus_one);
+			continue;
+
+		}
+
+		root = _mm_sqrt_ps(discriminant);
+		nb = _mm_mul_ps(minus_one, b);
+		t1 = _mm_div_ps(_mm_add_ps(nb, root), two_a);
+		t0 = _mm_div_ps(_mm_sub_ps(nb, root), two_a);
+
+		// Prefer t0, then t1, otherwise -1; no solution when the discriminant is negative
+		mask = _mm_cmpge_ps(t1, zero);
+		result = _mm_or_ps(_mm_and_ps(mask, t1), _mm_andnot_ps(mask, minus_one));
+		mask = _mm_cmpge_ps(t0, zero);
+		result = _mm_or_ps(_mm_and_ps(mask, t0), _mm_andnot_ps(mask, result));
+		mask = _mm_cmplt_ps(discriminant, zero);
+		result = _mm_or_ps(_mm_and_ps(mask, minus_one), _mm_andnot_ps(mask, result));
+
+		_mm_storeu_ps(t + index, result);
+
+	}
+
+	sphere_packet_single_scalar(ro, rd, x + index, y + index, z + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * plane_packet_single_sse2
+ *
+ * @description four single precision planes per step using SSE2
+ */
+__attribute__((target("sse2")))
+static void plane_packet_single_sse2(float *rd, const float *nx, const float *ny, const float *nz, const float *constant, int count, float *t) {
+	__m128 rd0 = _mm_set1_ps(rd[0]), rd1 = _mm_set1_ps(rd[1]), rd2 = _mm_set1_ps(rd[2]);
+	__m128 minus_one = _mm_set1_ps(-1), zero = _mm_setzero_ps();
+	__m128 n0, n1, n2, denominator, result, mask;
+	int index;
+
+	for(index = 0; index + 4 <= count; index += 4) {
+		n0 = _mm_loadu_ps(nx + index);
+		n1 = _mm_loadu_ps(ny + index);
+		n2 = _mm_loadu_ps(nz + index);
+
+		denominator = _mm_add_ps(_mm_add_ps(_mm_mul_ps(n0, rd0), _mm_mul_ps(n1, rd1)), _mm_mul_ps(n2, rd2));
+		result = _mm_div_ps(_mm_loadu_ps(constant + index), denominator);
+
+		mask = _mm_cmpge_ps(result, zero);
+		result = _mm_or_ps(_mm_and_ps(mask, result), _mm_andnot_ps(mask, minus_one));
+
+		_mm_storeu_ps(t + index, result);
+
+	}
+
+	plane_packet_single_scalar(rd, nx + index, ny + index, nz + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * sphere_packet_single_avx2
+ *
+ * @description eight single precision spheres per step using AVX2
+ */
+__attribute__((target("avx2")))
+static void sphere_packet_single_avx2(float *ro, float *rd, const float *x, const float *y, const float *z, const float *constant, int count, float *t) {
+	float a = ((rd[0] * rd[0]) + (rd[1] * rd[1]) + (rd[2] * rd[2]));
+	__m256 ro0 = _mm256_set1_ps(ro[0]), ro1 = _mm256_set1_ps(ro[1]), ro2 = _mm256_set1_ps(ro[2]);
+	__m256 rd0 = _mm256_set1_ps(rd[0]), rd1 = _mm256_set1_ps(rd[1]), rd2 = _mm256_set1_ps(rd[2]);
+	__m256 two_a = _mm256_set1_ps(2 * a), four_a = _mm256_set1_ps(4 * a);
+	__m256 two = _mm256_set1_ps(2), minus_one = _mm256_set1_ps(-1), zero = _mm256_setzero_ps();
+	__m256 dx, dy, dz, b, c, discriminant, root, nb, t0, t1, result;
+	int index;
+
+	for(index = 0; index + 8 <= count; index += 8) {
+		dx = _mm256_sub_ps(ro0, _mm256_loadu_ps(x + index));
+		dy = _mm256_sub_ps(ro1, _mm256_loadu_ps(y + index));
+		dz = _mm256_sub_ps(ro2, _mm256_loadu_ps(z + index));
+		c = _mm256_loadu_ps(constant + index);
+
+		b = _mm256_mul_ps(two, _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(rd0, dx), _mm256_mul_ps(rd1, dy)), _mm256_mul_ps(rd2, dz)));
+		discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(four_a, c));
+
+		// Skip the square root and divisions when every lane misses
+		if(_mm256_movemask_ps(_mm256_cmp_ps(discriminant, zero, _CMP_LT_OQ)) == 0xff) {
+			_mm256_storeu_ps(t + index, minus_one);
+			continue;
+
+		}
+
+		root = _mm256_sqrt_ps(discriminant);
+		nb = _mm256_mul_ps(minus_one, b);
+		t1 = _mm256_div_ps(_mm256_add_ps(nb, root), two_a);
+		t0 = _mm256_div_ps(_mm256_sub_ps(nb, root), two_a);
+
+		// Prefer t0, then t1, otherwise -1; no solution when the discriminant is negative
+		result = _mm256_blendv_ps(minus_one, t1, _mm256_cmp_ps(t1, zero, _CMP_GE_OQ));
+		result = _mm256_blendv_ps(result, t0, _mm256_cmp_ps(t0, zero, _CMP_GE_OQ));
+		result = _mm256_blendv_ps(result, minus_one, _mm256_cmp_ps(discriminant, zero, _CMP_LT_OQ));
+
+		_mm256_storeu_ps(t + index, result);
+
+	}
+
+	sphere_packet_single_scalar(ro, rd, x + index, y + index, z + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * plane_packet_single_avx2
+ *
+ * @description eight single precision planes per step using AVX2
+ */
+__attribute__((target("avx2")))
+static void plane_packet_single_avx2(float *rd, const float *nx, const float *ny, const float *nz, const float *constant, int count, float *t) {
+	__m256 rd0 = _mm256_set1_ps(rd[0]), rd1 = _mm256_set1_ps(rd[1]), rd2 = _mm256_set1_ps(rd[2]);
+	__m256 minus_one = _mm256_set1_ps(-1), zero = _mm256_setzero_ps();
+	__m256 n0, n1, n2, denominator, result;
+	int index;
+
+	for(index = 0; index + 8 <= count; index += 8) {
+		n0 = _mm256_loadu_ps(nx + index);
+		n1 = _mm256_loadu_ps(ny + index);
+		n2 = _mm256_loadu_ps(nz + index);
+
+		denominator = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(n0, rd0), _mm256_mul_ps(n1, rd1)), _mm256_mul_ps(n2, rd2));
+		result = _mm256_div_ps(_mm256_loadu_ps(constant + index), denominator);
+		result = _mm256_blendv_ps(minus_one, result, _mm256_cmp_ps(result, zero, _CMP_GE_OQ));
+
+		_mm256_storeu_ps(t + index, result);
+
+	}
+
+	plane_packet_single_scalar(rd, nx + index, ny + index, nz + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * sphere_packet_single_avx512
+ *
+ * @description sixteen single precision spheres per step using AVX-512
+ */
+__attribute__((target("avx512f")))
+static void sphere_packet_single_avx512(float *ro, float *rd, const float *x, const float *y, const float *z, const float *constant, int count, float *t) {
+	float a = ((rd[0] * rd[0]) + (rd[1] * rd[1]) + (rd[2] * rd[2]));
+	__m512 ro0 = _mm512_set1_ps(ro[0]), ro1 = _mm512_set1_ps(ro[1]), ro2 = _mm512_set1_ps(ro[2]);
+	__m512 rd0 = _mm512_set1_ps(rd[0]), rd1 = _mm512_set1_ps(rd[1]), rd2 = _mm512_set1_ps(rd[2]);
+	__m512 two_a = _mm512_set1_ps(2 * a), four_a = _mm512_set1_ps(4 * a);
+	__m512 two = _mm512_set1_ps(2), minus_one = _mm512_set1_ps(-1), zero = _mm512_setzero_ps();
+	__m512 dx, dy, dz, b, c, discriminant, root, nb, t0, t1, result;
+	int index;
+
+	for(index = 0; index + 16 <= count; index += 16) {
+		dx = _mm512_sub_ps(ro0, _mm512_loadu_ps(x + index));
+		dy = _mm512_sub_ps(ro1, _mm512_loadu_ps(y + index));
+		dz = _mm512_sub_ps(ro2, _mm512_loadu_ps(z + index));
+		c = _mm512_loadu_ps(constant + index);
+
+		b = _mm512_mul_ps(two, _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(rd0, dx), _mm512_mul_ps(rd1, dy)), _mm512_mul_ps(rd2, dz)));
+		discriminant = _mm512_sub_ps(_mm512_mul_ps(b, b), _mm512_mul_ps(four_a, c));
+
+		// Skip the square root and divisions when every lane misses
+		if(_mm512_cmp_ps_mask(discriminant, zero, _CMP_LT_OQ) == 0xffff) {
+			_mm512_storeu_ps(t + index, minus_one);
+			continue;
+
+		}
+
+		root = _mm512_sqrt_ps(discriminant);
+		nb = _mm512_mul_ps(minus_one, b);
+		t1 = _mm512_div_ps(_mm512_add_ps(nb, root), two_a);
+		t0 = _mm512_div_ps(_mm512_sub_ps(nb, root), two_a);
+
+		// Prefer t0, then t1, otherwise -1; no solution when the discriminant is negative
+		result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(t1, zero, _CMP_GE_OQ), minus_one, t1);
+		result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(t0, zero, _CMP_GE_OQ), result, t0);
+		result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(discriminant, zero, _CMP_LT_OQ), result, minus_one);
+
+		_mm512_storeu_ps(t + index, result);
+
+	}
+
+	sphere_packet_single_scalar(ro, rd, x + index, y + index, z + index, constant + index, count - index, t + index);
+
+}
+
+
+/**
+ * plane_packet_single_avx512
+ *
+ * @description sixteen single precision planes per step using AVX-512
+ */
+__attribute__((target("avx512f")))
+static void plane_packet_single_avx512(float *rd, const float *nx, const float *ny, const float *nz, const float *constant, int count, float *t) {
+	__m512 rd0 = _mm512_set1_ps(rd[0]), rd1 = _mm512_set1_ps(rd[1]), rd2 = _mm512_set1_ps(rd[2]);
+	__m512 minus_one = _mm512_set1_ps(-1), zero = _mm512_setzero_ps();
+	__m512 n0, n1, n2, denominator, result;
+	int index;
+
+	for(index = 0; index + 16 <= count; index += 16) {
+		n0 = _mm512_loadu_ps(nx + index);
+		n1 = _mm512_loadu_ps(ny + index);
+		n2 = _mm512_loadu_ps(nz + index);
+
+		denominator = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(n0, rd0), _mm512_mul_ps(n1, rd1)), _mm512_mul_ps(n2, rd2));
+		result = _mm512_div_ps(_mm512_loadu_ps(constant + index), denominator);
+		result = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(result, zero, _CMP_GE_OQ), minus_one, result);
+
+		_mm512_storeu_ps(t + index, result);
+
+	}
+
+	plane_packet_single_scalar(rd, nx + index, ny + index, nz + index, constant + index, count - index, t + index);
+
+}
+
+#endif
+
+
+/**
+ * simd_detect
+ *
+ * @returns the widest SimdLevel supported by the processor and operating system
+ * @description runtime cpu feature detection
+ */
+SimdLevel simd_detect(void) {
+#ifdef SIMD_X86
+	__builtin_cpu_init();
+
+	if(__builtin_cpu_supports("avx512f")) {
+		return(SIMD_AVX512);
+
+	} else if(__builtin_cpu_supports("avx2")) {
+		return(SIMD_AVX2);
+
+	} else if(__builtin_cpu_supports("sse2")) {
+		return(SIMD_SSE2);
+
+	}
+#endif
+
+	return(SIMD_SCALAR);
+
+}
+
+
+/**
+ * simd_select
+ *
+ * @param level - widest level the caller allows
+ * @returns the level actually selected
+ * @description installs the packet kernels for the given level, clamped to what the processor
+ * supports
+ */
+SimdLevel simd_select(SimdLevel level) {
+	SimdLevel supported = simd_detect();
+
+	if(level > supported) {
+		level = supported;
+
+	}
+
+	sphere_packet = sphere_packet_scalar;
+	plane_packet = plane_packet_scalar;
+	sphere_packet_single = sphere_packet_single_scalar;
+	plane_packet_single = plane_packet_single_scalar;
+
+#ifdef SIMD_X86
+	if(level == SIMD_AVX512) {
+		sphere_packet = sphere_packet_avx512;
+		plane_packet = plane_packet_avx512;
+		sphere_packet_single = sphere_packet_single_avx512;
+		plane_packet_single = plane_packet_single_avx512;
+
+	} else if(level == SIMD_AVX2) {
+		sphere_packet = sphere_packet_avx2;
+		plane_packet = plane_packet_avx2;
+		sphere_packet_single = sphere_packet_single_avx2;
+		plane_packet_single = plane_packet_single_avx2;
+
+	} else if(level == SIMD_SSE2) {
+		sphere_packet = sphere_packet_sse2;
+		plane_packet = plane_packet_sse2;
+		sphere_packet_single = sphere_packet_single_sse2;
+		plane_packet_single = plane_packet_single_sse2;
+
+	}
+#endif
+
+	return level;
+
+}
+
+
+/**
+ * simd_level_name
+ *
+ * @param level - SimdLevel
+ * @returns printable name of the level
+ * @description used for diagnostics and option parsing
+ */
+const char *simd_level_name(SimdLevel level) {
+	switch(level) {
+		case SIMD_SSE2:
+			return "sse2";
+
+		case SIMD_AVX2:
+			return "avx2";
+
+		case SIMD_AVX512:
+			return "avx512";
+
+		default:
+			return "scalar";
+
+	}
+
+}
+
+
+/**
+ * simd_parse_level
+ *
+ * @param name - level name as given on the command line
+ * @param level - receives the parsed level
+ * @returns 1 if the name is a known level, 0 otherwise
+ * @description inverse of simd_level_name
+ */
+int simd_parse_level(const char *name, SimdLevel *level) {
+	SimdLevel count;
+
+	for(count = SIMD_SCALAR; count <= SIMD_AVX512; count++) {
+		if(strcmp(name, simd_level_name(count)) == 0) {
+			*level = count;
+			return(1);
+
+		}
+
+	}
+
+	return(0);
+
+}
@@ -0,0 +1,294 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: simd.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef simd_h
+#define simd_h
+
+#include <math.h>
+
+// Number of primitives handed to a packet kernel per call by the render loop
+#define SIMD_BATCH 64
+
+/**
+ * SimdLevel
+ *
+ * @description instruction set used by the packet kernels, ordered from narrowest to widest
+ */
+typedef enum SimdLevel {
+	SIMD_SCALAR = 0,
+	SIMD_SSE2,
+	SIMD_AVX2,
+	SIMD_AVX512
+
+} SimdLevel;
+
+
+/**
+ * SpherePacket
+ *
+ * @description intersects one ray with count spheres stored as structure of arrays columns,
+ * t[i] receives exactly what sphere_hit returns for sphere i. constant holds each sphere's
+ * sphere_constant for the ray origin ro.
+ */
+typedef void (*SpherePacket)(double *ro, double *rd, const double *x, const double *y, const double *z, const double *constant, int count, double *t);
+
+
+/**
+ * PlanePacket
+ *
+ * @description intersects one ray with count planes stored as structure of arrays columns,
+ * t[i] receives exactly what plane_hit returns for plane i. constant holds each plane's
+ * plane_constant for the origin of the ray.
+ */
+typedef void (*PlanePacket)(double *rd, const double *nx, const double *ny, const double *nz, const double *constant, int count, double *t);
+
+
+/**
+ * SpherePacketSingle
+ *
+ * @description single precision SpherePacket, t[i] receives exactly what sphere_hit_single returns
+ * for sphere i
+ */
+typedef void (*SpherePacketSingle)(float *ro, float *rd, const float *x, const float *y, const float *z, const float *constant, int count, float *t);
+
+
+/**
+ * PlanePacketSingle
+ *
+ * @description single precision PlanePacket, t[i] receives exactly what plane_hit_single returns
+ * for plane i
+ */
+typedef void (*PlanePacketSingle)(float *rd, const float *nx, const float *ny, const float *nz, const float *constant, int count, float *t);
+
+// Kernels picked by simd_select, the scalar kernels until then
+extern SpherePacket sphere_packet;
+extern PlanePacket plane_packet;
+extern SpherePacketSingle sphere_packet_single;
+extern PlanePacketSingle plane_packet_single;
+
+
+/**
+ * sqr
+ *
+ * @param v - double precision floating point number
+ * @returns v squared
+ * @description math operation that squares a double precision floating
+ */
+static inline double sqr(double v) {
+	return v * v;
+
+}
+
+
+/**
+ * normalize
+ *
+ * @param v an array storing vector information
+ * @returns static function, no return 
+ * @description vector normalization, divide each component by its magnitude
+ */
+static inline void normalize(double *v) {
+	double len = sqrt(sqr(v[0]) + sqr(v[1]) + sqr(v[2]));
+	v[0] /= len;
+	v[1] /= len;
+	v[2] /= len;
+
+}
+
+
+/**
+ * sphere_constant
+ *
+ * @param ro - ray vector orgin
+ * @param cx, cy, cz - sphere center aka position
+ * @param radius - sphere radius
+ * @returns c of the sphere's quadratic, |ro - center|^2 - radius^2
+ * @description the part of the sphere equation that only depends on the ray origin, the same for
+ * every ray of a frame
+ */
+static inline double sphere_constant(double *ro, double cx, double cy, double cz, double radius) {
+	return sqr(ro[0] - cx) + sqr(ro[1] - cy) + sqr(ro[2] - cz) - sqr(radius);
+
+}
+
+
+/**
+ * sphere_hit
+ *
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param cx, cy, cz - sphere center aka position
+ * @param c - sphere_constant of the sphere for ro
+ * @returns t value of the closest intersection in front of the ray, -1 if none
+ * @description scalar ray sphere intersection, the reference every packet kernel reproduces
+ */
+static inline double sphere_hit(double *ro, double *rd, double cx, double cy, double cz, double c) {
+	double a, b, discriminant, root, t1, t0;
+
+	// Step 1.) Find the equation for the object you are interested in..
+	// Step 2.) Parameterize the equation with a center point
+	// Step 3.) Substitute the eq for a ray into our object equation.
+	// Step 4.) Solve for t.
+	// Step 4a.) Rewrite the equation (flatten).
+
+	a = (sqr(rd[0]) + sqr(rd[1]) + sqr(rd[2]));
+	b = (2 * (rd[0] * (ro[0] - cx) + rd[1] * (ro[1] - cy) + rd[2] * (ro[2] - cz)));
+
+	discriminant  = sqr(b) - 4 * a * c;
+
+	if(discriminant < 0) {
+		// Has no solution
+		return (-1);
+
+	}
+
+	// Quadratic formula
+	root = sqrt(discriminant);
+	t1 = (-1 * b + root) / (2 * a);
+	t0 = (-1 * b - root) / (2 * a);
+
+	if(t0 >= 0){
+		return t0;
+
+	} else if(t1 >= 0){
+		return t1;
+
+	} else {
+		return (-1);
+
+	}
+
+}
+
+
+/**
+ * plane_constant
+ *
+ * @param ro - ray vector orgin
+ * @param px, py, pz - a point on the plane
+ * @param nx, ny, nz - unit normal of the plane
+ * @returns numerator of the plane intersection, normal . (position - ro)
+ * @description the part of the plane equation that only depends on the ray origin, the same for
+ * every ray of a frame
+ */
+static inline double plane_constant(double *ro, double px, double py, double pz, double nx, double ny, double nz) {
+	return (nx * (px - ro[0])) + (ny * (py - ro[1])) + (nz * (pz - ro[2]));
+
+}
+
+
+/**
+ * plane_hit
+ *
+ * @param rd - ray vector direction
+ * @param nx, ny, nz - unit normal of the plane
+ * @param d - plane_constant of the plane for the origin of the ray
+ * @returns t value of the intersection in front of the ray, -1 if none
+ * @description scalar ray plane intersection, the reference every packet kernel reproduces
+ */
+static inline double plane_hit(double *rd, double nx, double ny, double nz, double d) {
+	// normal defines the orientation of the plane
+	// the property that the dot product of two perpendicular vectors is equal to 0
+	// p0 = plane position
+	// (p - p0) * normal = 0
+	// p = ro + rd + t
+	// (ro + rd * t - p0) * normal = 0
+	// ((ppos - ro) * normal) / (rd * normal) <- Dot product - a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+	double denominator, t;
+
+	denominator = (nx * rd[0]) + (ny * rd[1]) + (nz * rd[2]);
+
+	t = d / denominator;
+
+	if(t >= 0) {
+		return t;
+
+	} else {
+		return (-1);
+
+	}
+
+}
+
+
+/**
+ * sphere_hit_single
+ *
+ * @param ro - ray vector orgin
+ * @param rd - ray vector direction
+ * @param cx, cy, cz - sphere center aka position
+ * @param c - sphere_constant of the sphere for ro, rounded to float
+ * @returns t value of the closest intersection in front of the ray, -1 if none
+ * @description sphere_hit evaluated in single precision, the reference every single precision
+ * packet kernel reproduces
+ */
+static inline float sphere_hit_single(float *ro, float *rd, float cx, float cy, float cz, float c) {
+	float a, b, discriminant, root, t1, t0;
+
+	a = ((rd[0] * rd[0]) + (rd[1] * rd[1]) + (rd[2] * rd[2]));
+	b = (2 * (rd[0] * (ro[0] - cx) + rd[1] * (ro[1] - cy) + rd[2] * (ro[2] - cz)));
+
+	discriminant = (b * b) - 4 * a * c;
+
+	if(discriminant < 0) {
+		return (-1);
+
+	}
+
+	root = sqrtf(discriminant);
+	t1 = (-1 * b + root) / (2 * a);
+	t0 = (-1 * b - root) / (2 * a);
+
+	if(t0 >= 0){
+		return t0;
+
+	} else if(t1 >= 0){
+		return t1;
+
+	} else {
+		return (-1);
+
+	}
+
+}
+
+
+/**
+ * plane_hit_single
+ *
+ * @param rd - ray vector direction
+ * @param nx, ny, nz - unit normal of the plane
+ * @param d - plane_constant of the plane for the origin of the ray, rounded to float
+ * @returns t value of the intersection in front of the ray, -1 if none
+ * @description plane_hit evaluated in single precision, the reference every single precision
+ * packet kernel reproduces
+ */
+static inline float plane_hit_single(float *rd, float nx, float ny, float nz, float d) {
+	float denominator, t;
+
+	denominator = (nx * rd[0]) + (ny * rd[1]) + (nz * rd[2]);
+
+	t = d / denominator;
+
+	if(t >= 0) {
+		return t;
+
+	} else {
+		return (-1);
+
+	}
+
+}
+
+// function declarations
+SimdLevel simd_detect(void);
+SimdLevel simd_select(SimdLevel level);
+const char *simd_level_name(SimdLevel level);
+int simd_parse_level(const char *name, SimdLevel *level);
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: stats.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "stats.h"
+
+// Names of the phases in the summary, in StatsPhase order
+static const char *phase_names[NUM_PHASES] = {"parse", "scene", "bvh", "render", "write"};
+
+// Totals of every merged counter and phase timer, only touched once stats_enable is called
+static int enabled = 0;
+static RenderStats totals;
+static pthread_mutex_t totals_lock = PTHREAD_MUTEX_INITIALIZER;
+static double phase_ms[NUM_PHASES];
+static double phase_start[NUM_PHASES];
+static double run_start;
+
+/**
+ * stats_now
+ *
+ * @returns milliseconds on a monotonic clock
+ * @description reads the clock the phases are timed with
+ */
+static double stats_now(void) {
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return(now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0);
+
+}
+
+
+/**
+ * stats_enable
+ *
+ * @returns void
+ * @description starts collecting counters and phase times, the run is timed from here
+ */
+void stats_enable(void) {
+	enabled = 1;
+	memset(&totals, 0, sizeof(RenderStats));
+	memset(phase_ms, 0, sizeof(phase_ms));
+	run_start = stats_now();
+
+}
+
+
+/**
+ * stats_enabled
+ *
+ * @returns 1 when statistics are collected, 0 otherwise
+ * @description lets callers skip work that only feeds the statistics
+ */
+int stats_enabled(void) {
+	return enabled;
+
+}
+
+
+/**
+ * stats_start
+ *
+ * @param phase - phase that begins
+ * @returns void
+ * @description starts the timer of a phase
+ */
+void stats_start(StatsPhase phase) {
+	if(enabled) {
+		phase_start[phase] = stats_now();
+
+	}
+
+}
+
+
+/**
+ * stats_stop
+ *
+ * @param phase - phase that ends
+ * @returns void
+ * @description adds the time since stats_start to the phase, a phase may be timed in pieces
+ */
+void stats_stop(StatsPhase phase) {
+	if(enabled) {
+		phase_ms[phase] = phase_ms[phase] + (stats_now() - phase_start[phase]);
+
+	}
+
+}
+
+
+/**
+ * stats_merge
+ *
+ * @param counters - counters of one render thread
+ * @returns void
+ * @description adds a thread's counters to the totals, called once per tile so the lock is
+ * never contended by the per ray work
+ */
+void stats_merge(const RenderStats *counters) {
+	if(enabled == 0) {
+		return;
+
+	}
+
+	pthread_mutex_lock(&totals_lock);
+	totals.rays += counters->rays;
+	totals.rays_sphere += counters->rays_sphere;
+	totals.rays_plane += counters->rays_plane;
+	totals.rays_missed += counters->rays_missed;
+	totals.sphere_tests += counters->sphere_tests;
+	totals.sphere_hits += counters->sphere_hits;
+	totals.plane_tests += counters->plane_tests;
+	totals.plane_hits += counters->plane_hits;
+	totals.box_tests += counters->box_tests;
+	pthread_mutex_unlock(&totals_lock);
+
+}
+
+
+/**
+ * stats_print
+ *
+ * @param fpointer - stream the summary is written to
+ * @param num_objects - objects in the scene
+ * @param num_spheres - spheres in the render scene
+ * @param num_planes - planes in the render scene
+ * @param num_threads - render threads
+ * @returns void
+ * @description writes the counters, the time of each phase, and the time since stats_enable as
+ * one json object
+ */
+void stats_print(FILE *fpointer, int num_objects, int num_spheres, int num_planes, int num_threads) {
+	double total_ms;
+	int phase;
+
+	if(enabled == 0) {
+		return;
+
+	}
+
+	total_ms = stats_now() - run_start;
+
+	fprintf(fpointer, "{\"objects\": %d, \"spheres\": %d, \"planes\": %d, \"threads\": %d, ", num_objects, num_spheres, num_planes, num_threads);
+	fprintf(fpointer, "\"rays\": %llu, \"rays_sphere\": %llu, \"rays_plane\": %llu, \"rays_missed\": %llu, ",
+		totals.rays, totals.rays_sphere, totals.rays_plane, totals.rays_missed);
+	fprintf(fpointer, "\"sphere_tests\": %llu, \"sphere_hits\": %llu, \"plane_tests\": %llu, \"plane_hits\": %llu, \"box_tests\": %llu, ",
+		totals.sphere_tests, totals.sphere_hits, totals.plane_tests, totals.plane_hits, totals.box_tests);
+
+	for(phase = 0; phase < NUM_PHASES; phase++) {
+		fprintf(fpointer, "\"%s_ms\": %.3f, ", phase_names[phase], phase_ms[phase]);
+
+	}
+
+	fprintf(fpointer, "\"total_ms\": %.3f, \"rays_per_sec\": %.0f}\n", total_ms,
+		(phase_ms[PHASE_RENDER] > 0) ? totals.rays * 1000.0 / phase_ms[PHASE_RENDER] : 0.0);
+	fflush(fpointer);
+
+}
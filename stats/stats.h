@@ -0,0 +1,55 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: stats.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef stats_h
+#define stats_h
+
+/**
+ * StatsPhase
+ *
+ * @description timed phases of a run. Parse reads the scene file, scene builds the render scene
+ * from the parsed objects, bvh builds the bounding volume hierarchy, render casts the rays, and
+ * write writes the image out, whatever part of it is left once rendering is done.
+ */
+typedef enum StatsPhase {
+	PHASE_PARSE = 0,
+	PHASE_SCENE,
+	PHASE_BVH,
+	PHASE_RENDER,
+	PHASE_WRITE,
+	NUM_PHASES
+
+} StatsPhase;
+
+
+/**
+ * RenderStats
+ *
+ * @description counters of a render. Every ray ends on a sphere, on a plane, or misses. Tests
+ * count primitive intersection tests, hits the tests that found an intersection in front of the
+ * ray, and box_tests the bounding volume hierarchy boxes tested. Render threads count into their
+ * own copy and merge it into the totals once per tile.
+ */
+typedef struct RenderStats {
+	unsigned long long rays;
+	unsigned long long rays_sphere, rays_plane, rays_missed;
+	unsigned long long sphere_tests, sphere_hits;
+	unsigned long long plane_tests, plane_hits;
+	unsigned long long box_tests;
+
+} RenderStats;
+
+// function declarations
+void stats_enable(void);
+int stats_enabled(void);
+void stats_start(StatsPhase phase);
+void stats_stop(StatsPhase phase);
+void stats_merge(const RenderStats *counters);
+void stats_print(FILE *fpointer, int num_objects, int num_spheres, int num_planes, int num_threads);
+
+#endif
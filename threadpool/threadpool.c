@@ -0,0 +1,540 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: threadpool.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "threadpool.h"
+
+// Index of the deque owned by the calling thread, -1 for threads outside of a pool
+static __thread int worker_index = -1;
+static __thread ThreadPool *worker_pool = NULL;
+
+/**
+ * WorkerStart
+ *
+ * @description start up arguments handed to each worker thread
+ */
+typedef struct WorkerStart {
+	ThreadPool *pool;
+	int index;
+
+} WorkerStart;
+
+
+/**
+ * deque_push
+ *
+ * @param deque - task deque to push onto
+ * @param task - task to add to the bottom of the deque
+ * @returns void
+ * @description pushes a task onto the bottom of a deque, doubling the storage when full
+ */
+static void deque_push(TaskDeque *deque, Task task) {
+	Task *tasks;
+	int index, count;
+
+	pthread_mutex_lock(&deque->lock);
+
+	count = deque->bottom - deque->top;
+
+	if(count == deque->capacity) {
+		tasks = malloc(sizeof(Task) * deque->capacity * 2);
+
+		if(tasks == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		// Unwrap the circular buffer into the new storage
+		for(index = 0; index < count; index++) {
+			tasks[index] = deque->tasks[(deque->top + index) % deque->capacity];
+
+		}
+
+		free(deque->tasks);
+		deque->tasks = tasks;
+		deque->capacity = deque->capacity * 2;
+		deque->top = 0;
+		deque->bottom = count;
+
+	}
+
+	deque->tasks[deque->bottom % deque->capacity] = task;
+	deque->bottom = deque->bottom + 1;
+
+	pthread_mutex_unlock(&deque->lock);
+
+}
+
+
+/**
+ * deque_pop
+ *
+ * @param deque - task deque to take from
+ * @param task - receives the task taken
+ * @param steal - 0 to take the newest task (owner), 1 to take the oldest task (thief)
+ * @returns 1 if a task was taken, 0 if the deque was empty
+ * @description removes a task from the bottom of the deque for its owner or from the top
+ * for a stealing worker
+ */
+static int deque_pop(TaskDeque *deque, Task *task, int steal) {
+	int found = 0;
+
+	pthread_mutex_lock(&deque->lock);
+
+	if(deque->bottom > deque->top) {
+		if(steal) {
+			*task = deque->tasks[deque->top % deque->capacity];
+			deque->top = deque->top + 1;
+
+		} else {
+			deque->bottom = deque->bottom - 1;
+			*task = deque->tasks[deque->bottom % deque->capacity];
+
+		}
+
+		// Rewind the counters once the deque drains so they never overflow
+		if(deque->top == deque->bottom) {
+			deque->top = 0;
+			deque->bottom = 0;
+
+		}
+
+		found = 1;
+
+	}
+
+	pthread_mutex_unlock(&deque->lock);
+
+	return found;
+
+}
+
+
+/**
+ * find_task
+ *
+ * @param pool - thread pool
+ * @param index - deque index of the calling worker
+ * @param task - receives the task found
+ * @returns 1 if a task was found, 0 otherwise
+ * @description looks for work in the worker's own deque first, then walks the other deques
+ * stealing the oldest task of the first non-empty one
+ */
+static int find_task(ThreadPool *pool, int index, Task *task) {
+	int count;
+
+	if(deque_pop(&pool->deques[index], task, 0)) {
+		return(1);
+
+	}
+
+	for(count = 1; count < pool->num_threads; count++) {
+		if(deque_pop(&pool->deques[(index + count) % pool->num_threads], task, 1)) {
+			return(1);
+
+		}
+
+	}
+
+	return(0);
+
+}
+
+
+/**
+ * worker_main
+ *
+ * @param arg - WorkerStart arguments
+ * @returns NULL
+ * @description worker thread loop, runs tasks until the pool shuts down sleeping whenever
+ * no deque holds any work
+ */
+static void *worker_main(void *arg) {
+	WorkerStart start = *(WorkerStart *)arg;
+	ThreadPool *pool = start.pool;
+	Task task;
+
+	free(arg);
+	worker_index = start.index;
+	worker_pool = pool;
+
+	while(1) {
+		if(find_task(pool, start.index, &task)) {
+			pthread_mutex_lock(&pool->lock);
+			pool->queued = pool->queued - 1;
+			pthread_mutex_unlock(&pool->lock);
+
+			task.function(task.arg);
+
+			pthread_mutex_lock(&pool->lock);
+			pool->pending = pool->pending - 1;
+
+			if(pool->pending == 0) {
+				pthread_cond_broadcast(&pool->work_done);
+
+			}
+
+			pthread_mutex_unlock(&pool->lock);
+
+		} else {
+			pthread_mutex_lock(&pool->lock);
+
+			while((pool->queued <= 0) && (pool->shutdown == 0)) {
+				pthread_cond_wait(&pool->work_available, &pool->lock);
+
+			}
+
+			if((pool->shutdown != 0) && (pool->queued <= 0)) {
+				pthread_mutex_unlock(&pool->lock);
+				break;
+
+			}
+
+			pthread_mutex_unlock(&pool->lock);
+
+		}
+
+	}
+
+	return NULL;
+
+}
+
+
+/**
+ * threadpool_default_threads
+ *
+ * @returns number of online processors, at least 1
+ * @description used when the user asks for as many threads as the machine has cores
+ */
+int threadpool_default_threads(void) {
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if(count < 1) {
+		return(1);
+
+	}
+
+	return((int)count);
+
+}
+
+
+/**
+ * threadpool_create
+ *
+ * @param num_threads - number of worker threads to start
+ * @returns a pointer to the new thread pool
+ * @description allocates a thread pool, one task deque per worker, and starts the workers
+ */
+ThreadPool *threadpool_create(int num_threads) {
+	ThreadPool *pool;
+	WorkerStart *start;
+	int index;
+
+	if(num_threads < 1) {
+		num_threads = 1;
+
+	}
+
+	pool = malloc(sizeof(ThreadPool));
+
+	if(pool == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	pool->num_threads = num_threads;
+	pool->threads = malloc(sizeof(pthread_t) * num_threads);
+	pool->deques = malloc(sizeof(TaskDeque) * num_threads);
+
+	if((pool->threads == NULL) || (pool->deques == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->work_available, NULL);
+	pthread_cond_init(&pool->work_done, NULL);
+	pool->queued = 0;
+	pool->pending = 0;
+	pool->next_deque = 0;
+	pool->shutdown = 0;
+
+	for(index = 0; index < num_threads; index++) {
+		pthread_mutex_init(&pool->deques[index].lock, NULL);
+		pool->deques[index].capacity = 64;
+		pool->deques[index].top = 0;
+		pool->deques[index].bottom = 0;
+		pool->deques[index].tasks = malloc(sizeof(Task) * pool->deques[index].capacity);
+
+		if(pool->deques[index].tasks == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	for(index = 0; index < num_threads; index++) {
+		start = malloc(sizeof(WorkerStart));
+
+		if(start == NULL) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+		start->pool = pool;
+		start->index = index;
+
+		if(pthread_create(&pool->threads[index], NULL, worker_main, start) != 0) {
+			fprintf(stderr, "Error, unable to start worker thread.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	return pool;
+
+}
+
+
+/**
+ * threadpool_submit
+ *
+ * @param pool - thread pool
+ * @param function - task function
+ * @param arg - argument handed to the task function
+ * @returns void
+ * @description queues a task. Tasks submitted from a worker go onto that worker's own deque,
+ * tasks submitted from outside the pool are dealt round robin across the deques.
+ */
+void threadpool_submit(ThreadPool *pool, ThreadTask function, void *arg) {
+	Task task;
+	int index;
+
+	task.function = function;
+	task.arg = arg;
+
+	if((worker_pool == pool) && (worker_index >= 0)) {
+		index = worker_index;
+
+	} else {
+		pthread_mutex_lock(&pool->lock);
+		index = pool->next_deque;
+		pool->next_deque = (pool->next_deque + 1) % pool->num_threads;
+		pthread_mutex_unlock(&pool->lock);
+
+	}
+
+	// Count the task as pending before it becomes visible so a wait can not slip past it
+	pthread_mutex_lock(&pool->lock);
+	pool->pending = pool->pending + 1;
+	pthread_mutex_unlock(&pool->lock);
+
+	deque_push(&pool->deques[index], task);
+
+	pthread_mutex_lock(&pool->lock);
+	pool->queued = pool->queued + 1;
+	pthread_cond_signal(&pool->work_available);
+	pthread_mutex_unlock(&pool->lock);
+
+}
+
+
+/**
+ * threadpool_wait
+ *
+ * @param pool - thread pool
+ * @returns void
+ * @description blocks the caller until every submitted task, including tasks submitted by
+ * other tasks, has finished
+ */
+void threadpool_wait(ThreadPool *pool) {
+	pthread_mutex_lock(&pool->lock);
+
+	while(pool->pending > 0) {
+		pthread_cond_wait(&pool->work_done, &pool->lock);
+
+	}
+
+	pthread_mutex_unlock(&pool->lock);
+
+}
+
+
+/**
+ * threadpool_destroy
+ *
+ * @param pool - thread pool
+ * @returns void
+ * @description finishes outstanding work, stops the workers and releases the pool
+ */
+void threadpool_destroy(ThreadPool *pool) {
+	int index;
+
+	threadpool_wait(pool);
+
+	pthread_mutex_lock(&pool->lock);
+	pool->shutdown = 1;
+	pthread_cond_broadcast(&pool->work_available);
+	pthread_mutex_unlock(&pool->lock);
+
+	for(index = 0; index < pool->num_threads; index++) {
+		pthread_join(pool->threads[index], NULL);
+
+	}
+
+	for(index = 0; index < pool->num_threads; index++) {
+		pthread_mutex_destroy(&pool->deques[index].lock);
+		free(pool->deques[index].tasks);
+
+	}
+
+	pthread_mutex_destroy(&pool->lock);
+	pthread_cond_destroy(&pool->work_available);
+	pthread_cond_destroy(&pool->work_done);
+	free(pool->deques);
+	free(pool->threads);
+	free(pool);
+
+}
+
+
+/**
+ * queue_create
+ *
+ * @param capacity - most items the queue holds before queue_push blocks
+ * @returns a newly allocated empty Queue
+ * @description creates a bounded queue
+ */
+Queue *queue_create(int capacity) {
+	Queue *queue;
+
+	queue = malloc(sizeof(Queue));
+
+	if(queue != NULL) {
+		queue->items = malloc(sizeof(void *) * capacity);
+
+	}
+
+	if((queue == NULL) || (queue->items == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	pthread_mutex_init(&queue->lock, NULL);
+	pthread_cond_init(&queue->not_empty, NULL);
+	pthread_cond_init(&queue->not_full, NULL);
+	queue->capacity = capacity;
+	queue->head = 0;
+	queue->count = 0;
+	queue->closed = 0;
+
+	return queue;
+
+}
+
+
+/**
+ * queue_push
+ *
+ * @param queue - queue
+ * @param item - item to append
+ * @returns void
+ * @description appends an item, waiting while the queue is full
+ */
+void queue_push(Queue *queue, void *item) {
+	pthread_mutex_lock(&queue->lock);
+
+	while(queue->count == queue->capacity) {
+		pthread_cond_wait(&queue->not_full, &queue->lock);
+
+	}
+
+	queue->items[(queue->head + queue->count) % queue->capacity] = item;
+	queue->count = queue->count + 1;
+	pthread_cond_signal(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+
+}
+
+
+/**
+ * queue_pop
+ *
+ * @param queue - queue
+ * @returns the oldest item, NULL once the queue is closed and empty
+ * @description removes the oldest item, waiting while the queue is empty and open
+ */
+void *queue_pop(Queue *queue) {
+	void *item = NULL;
+
+	pthread_mutex_lock(&queue->lock);
+
+	while((queue->count == 0) && (queue->closed == 0)) {
+		pthread_cond_wait(&queue->not_empty, &queue->lock);
+
+	}
+
+	if(queue->count > 0) {
+		item = queue->items[queue->head];
+		queue->head = (queue->head + 1) % queue->capacity;
+		queue->count = queue->count - 1;
+		pthread_cond_signal(&queue->not_full);
+
+	}
+
+	pthread_mutex_unlock(&queue->lock);
+
+	return item;
+
+}
+
+
+/**
+ * queue_close
+ *
+ * @param queue - queue
+ * @returns void
+ * @description marks the end of the items, consumers drain what is left and then see NULL
+ */
+void queue_close(Queue *queue) {
+	pthread_mutex_lock(&queue->lock);
+	queue->closed = 1;
+	pthread_cond_broadcast(&queue->not_empty);
+	pthread_mutex_unlock(&queue->lock);
+
+}
+
+
+/**
+ * queue_destroy
+ *
+ * @param queue - queue no thread is using any more
+ * @returns void
+ * @description releases a queue, the items themselves are owned by the caller
+ */
+void queue_destroy(Queue *queue) {
+	pthread_mutex_destroy(&queue->lock);
+	pthread_cond_destroy(&queue->not_empty);
+	pthread_cond_destroy(&queue->not_full);
+	free(queue->items);
+	free(queue);
+
+}
@@ -0,0 +1,101 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: threadpool.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef threadpool_h
+#define threadpool_h
+
+#include <pthread.h>
+
+/**
+ * ThreadTask
+ *
+ * @description function signature of a unit of work executed by the thread pool
+ */
+typedef void (*ThreadTask)(void *arg);
+
+
+/**
+ * Task
+ *
+ * @description a queued unit of work, the function to run and its argument
+ */
+typedef struct Task {
+	ThreadTask function;
+	void *arg;
+
+} Task;
+
+
+/**
+ * TaskDeque
+ *
+ * @description a double ended queue of tasks owned by a single worker. The owner pushes and
+ * pops tasks at the bottom (newest first), idle workers steal from the top (oldest first).
+ */
+typedef struct TaskDeque {
+	pthread_mutex_t lock;
+	Task *tasks;
+	int top, bottom;
+	int capacity;
+
+} TaskDeque;
+
+
+/**
+ * ThreadPool
+ *
+ * @description a fixed set of worker threads each with its own task deque. Workers that run out
+ * of work steal from the other deques so that uneven tasks are balanced across the pool.
+ */
+typedef struct ThreadPool {
+	int num_threads;
+	pthread_t *threads;
+	TaskDeque *deques;
+
+	pthread_mutex_t lock;
+	pthread_cond_t work_available;
+	pthread_cond_t work_done;
+	int queued;
+	int pending;
+	int next_deque;
+	int shutdown;
+
+} ThreadPool;
+
+
+/**
+ * Queue
+ *
+ * @description bounded first in first out queue of pointers connecting a producer thread to a
+ * consumer thread. Pushing onto a full queue blocks until there is room, popping from an empty
+ * queue blocks until an item arrives or the queue is closed.
+ */
+typedef struct Queue {
+	pthread_mutex_t lock;
+	pthread_cond_t not_empty;
+	pthread_cond_t not_full;
+	void **items;
+	int capacity;
+	int head, count;
+	int closed;
+
+} Queue;
+
+// function declarations
+int threadpool_default_threads(void);
+ThreadPool *threadpool_create(int num_threads);
+void threadpool_submit(ThreadPool *pool, ThreadTask function, void *arg);
+void threadpool_wait(ThreadPool *pool);
+void threadpool_destroy(ThreadPool *pool);
+Queue *queue_create(int capacity);
+void queue_push(Queue *queue, void *item);
+void *queue_pop(Queue *queue);
+void queue_close(Queue *queue);
+void queue_destroy(Queue *queue);
+
+#endif
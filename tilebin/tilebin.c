@@ -0,0 +1,297 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: tilebin.c
+ * Copyright © 2026 All rights reserved
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "..\arena\arena.h"
+#include "..\json\json.h"
+#include "..\scene\scene.h"
+#include "tilebin.h"
+
+// Relative slack in the tests that decide whether a sphere lies wholly in front of or behind the camera
+#define TILEBIN_SLACK 1e-9
+
+/**
+ * sphere_geometry
+ *
+ * @param scene - prepared render scene
+ * @param index - sphere column
+ * @param center - receives the center of the sphere relative to the ray origin
+ * @returns the radius of the sphere
+ * @description reads a sphere from the double precision columns, or from the single precision
+ * geometry once the double columns are released. Single precision spheres only keep the prepared
+ * constant, the radius is recovered from it, unless the scene is compact and stores it.
+ */
+static double sphere_geometry(RenderScene *scene, int index, double *center) {
+	double squared;
+
+	if(scene->sphere_x != NULL) {
+		center[0] = scene->sphere_x[index] - scene->origin[0];
+		center[1] = scene->sphere_y[index] - scene->origin[1];
+		center[2] = scene->sphere_z[index] - scene->origin[2];
+
+		return scene->sphere_radius[index];
+
+	}
+
+	center[0] = (double)scene->single->sphere_x[index] - scene->origin[0];
+	center[1] = (double)scene->single->sphere_y[index] - scene->origin[1];
+	center[2] = (double)scene->single->sphere_z[index] - scene->origin[2];
+
+	if(scene->compact) {
+		return scene->single->sphere_radius[index];
+
+	}
+
+	squared = center[0] * center[0] + center[1] * center[1] + center[2] * center[2] - scene->single->sphere_c[index];
+
+	return (squared > 0) ? sqrt(squared) : 0;
+
+}
+
+
+/**
+ * sphere_tiles
+ *
+ * @param bins - bins being built, its size and tile grid are set
+ * @param scene - prepared render scene
+ * @param index - sphere column
+ * @param range - receives the first and last tile column and the first and last tile row covered
+ * @returns 1 when the sphere covers at least one tile, 0 when no ray of the image can hit it
+ * @description bounds the sphere's projection on the image. Every ray leaves the origin through
+ * the point (u, v, 1) of the view plane, and the rays that hit a sphere wholly in front of the
+ * camera form a cone whose extent in u is bounded by the two planes through the v axis tangent to
+ * the sphere, likewise in v. The bounds are widened by a pixel so rounding never drops a sphere,
+ * and antialiasing samples anywhere in a pixel are covered. A sphere reaching behind the camera
+ * has no bounded projection and covers every tile, one wholly behind it is never hit.
+ */
+static int sphere_tiles(TileBins *bins, RenderScene *scene, int index, int *range) {
+	double center[3], radius, slack, a, root, u0, u1, v0, v1, x0, x1, y0, y1;
+	double pixel_width, pixel_height;
+
+	radius = sphere_geometry(scene, index, center);
+	slack = TILEBIN_SLACK * (fabs(center[0]) + fabs(center[1]) + fabs(center[2]) + radius);
+
+	if(center[2] + radius < -slack) {
+		return(0);
+
+	}
+
+	range[0] = 0;
+	range[1] = bins->tiles_x - 1;
+	range[2] = 0;
+	range[3] = bins->tiles_y - 1;
+	a = center[2] * center[2] - radius * radius;
+
+	if((center[2] - radius <= slack) || (a <= 0)) {
+		return(1);
+
+	}
+
+	// Tangent planes u = x / z and v = y / z, the roots of (x - u z)^2 = r^2 (1 + u^2)
+	root = radius * sqrt(center[0] * center[0] + center[2] * center[2] - radius * radius);
+	u0 = (center[0] * center[2] - root) / a;
+	u1 = (center[0] * center[2] + root) / a;
+	root = radius * sqrt(center[1] * center[1] + center[2] * center[2] - radius * radius);
+	v0 = (center[1] * center[2] - root) / a;
+	v1 = (center[1] * center[2] + root) / a;
+
+	// Pixel coordinates as the raycaster maps them, rows grow downwards as v shrinks
+	pixel_width = scene->camera_width / bins->width;
+	pixel_height = scene->camera_height / bins->height;
+	x0 = (u0 + scene->camera_width / 2.0) / pixel_width - 1.5;
+	x1 = (u1 + scene->camera_width / 2.0) / pixel_width + 0.5;
+	y0 = (scene->camera_height / 2.0 - v1) / pixel_height - 1.5;
+	y1 = (scene->camera_height / 2.0 - v0) / pixel_height + 0.5;
+
+	if((x1 < 0) || (y1 < 0) || (x0 >= bins->width) || (y0 >= bins->height) || (x0 != x0) || (y0 != y0)) {
+		return(0);
+
+	}
+
+	range[0] = (x0 > 0) ? (int)x0 / bins->tile_size : 0;
+	range[1] = (x1 < bins->width - 1) ? (int)x1 / bins->tile_size : bins->tiles_x - 1;
+	range[2] = (y0 > 0) ? (int)y0 / bins->tile_size : 0;
+	range[3] = (y1 < bins->height - 1) ? (int)y1 / bins->tile_size : bins->tiles_y - 1;
+
+	return(1);
+
+}
+
+
+/**
+ * tilebin_build
+ *
+ * @param scene - prepared render scene, in single precision when it renders in single precision
+ * @param width - width of the image in pixels
+ * @param height - height of the image in pixels
+ * @param tile_size - width and height of a tile in pixels
+ * @returns newly allocated TileBins
+ * @description bins every sphere into the tiles its projection covers, see sphere_tiles. The
+ * first pass counts each tile's candidates, the second lays them out tile after tile in sphere
+ * column order. The bins hold for the scene's current origin and geometry only, they are rebuilt
+ * when either changes.
+ */
+TileBins *tilebin_build(RenderScene *scene, int width, int height, int tile_size) {
+	TileBins *bins;
+	int *ranges, *cursor;
+	int index, num_tiles, tile, x, y, entry;
+
+	if(scene->prepared == 0) {
+		fprintf(stderr, "Error, the scene must be prepared before it is binned.\n");
+		exit(-1);
+
+	}
+
+	bins = calloc(1, sizeof(TileBins));
+
+	if(bins == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	bins->width = width;
+	bins->height = height;
+	bins->tile_size = tile_size;
+	bins->tiles_x = (width + tile_size - 1) / tile_size;
+	bins->tiles_y = (height + tile_size - 1) / tile_size;
+	num_tiles = bins->tiles_x * bins->tiles_y;
+
+	bins->start = calloc(num_tiles + 1, sizeof(int));
+	cursor = malloc(sizeof(int) * num_tiles);
+	ranges = malloc(sizeof(int) * 4 * (scene->num_spheres > 0 ? scene->num_spheres : 1));
+
+	if((bins->start == NULL) || (cursor == NULL) || (ranges == NULL)) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	// First pass, count the candidates of every tile
+	for(index = 0; index < scene->num_spheres; index++) {
+		if(sphere_tiles(bins, scene, index, &ranges[4 * index]) == 0) {
+			// An empty range, the sphere is in no tile
+			ranges[4 * index] = 1;
+			ranges[4 * index + 1] = 0;
+			ranges[4 * index + 2] = 1;
+			ranges[4 * index + 3] = 0;
+			continue;
+
+		}
+
+		for(y = ranges[4 * index + 2]; y <= ranges[4 * index + 3]; y++) {
+			for(x = ranges[4 * index]; x <= ranges[4 * index + 1]; x++) {
+				bins->start[y * bins->tiles_x + x + 1] += 1;
+
+			}
+
+		}
+
+	}
+
+	for(tile = 0; tile < num_tiles; tile++) {
+		bins->start[tile + 1] += bins->start[tile];
+		cursor[tile] = bins->start[tile];
+
+	}
+
+	bins->num_entries = bins->start[num_tiles];
+	bins->sphere = malloc(sizeof(int) * (bins->num_entries > 0 ? bins->num_entries : 1));
+
+	if(scene->single != NULL) {
+		bins->x_single = malloc(sizeof(float) * (bins->num_entries > 0 ? bins->num_entries : 1));
+		bins->y_single = malloc(sizeof(float) * (bins->num_entries > 0 ? bins->num_entries : 1));
+		bins->z_single = malloc(sizeof(float) * (bins->num_entries > 0 ? bins->num_entries : 1));
+		bins->c_single = malloc(sizeof(float) * (bins->num_entries > 0 ? bins->num_entries : 1));
+
+		if((bins->x_single == NULL) || (bins->y_single == NULL) || (bins->z_single == NULL) || (bins->c_single == NULL)) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	} else {
+		bins->x = malloc(sizeof(double) * (bins->num_entries > 0 ? bins->num_entries : 1));
+		bins->y = malloc(sizeof(double) * (bins->num_entries > 0 ? bins->num_entries : 1));
+		bins->z = malloc(sizeof(double) * (bins->num_entries > 0 ? bins->num_entries : 1));
+		bins->c = malloc(sizeof(double) * (bins->num_entries > 0 ? bins->num_entries : 1));
+
+		if((bins->x == NULL) || (bins->y == NULL) || (bins->z == NULL) || (bins->c == NULL)) {
+			fprintf(stderr, "Failed to allocate memory.\n");
+			exit(-1);
+
+		}
+
+	}
+
+	if(bins->sphere == NULL) {
+		fprintf(stderr, "Failed to allocate memory.\n");
+		exit(-1);
+
+	}
+
+	// Second pass, gather every sphere into the tiles it covers
+	for(index = 0; index < scene->num_spheres; index++) {
+		for(y = ranges[4 * index + 2]; y <= ranges[4 * index + 3]; y++) {
+			for(x = ranges[4 * index]; x <= ranges[4 * index + 1]; x++) {
+				entry = cursor[y * bins->tiles_x + x];
+				cursor[y * bins->tiles_x + x] = entry + 1;
+				bins->sphere[entry] = index;
+
+				if(scene->single != NULL) {
+					bins->x_single[entry] = scene->single->sphere_x[index];
+					bins->y_single[entry] = scene->single->sphere_y[index];
+					bins->z_single[entry] = scene->single->sphere_z[index];
+					bins->c_single[entry] = scene->single->sphere_c[index];
+
+				} else {
+					bins->x[entry] = scene->sphere_x[index];
+					bins->y[entry] = scene->sphere_y[index];
+					bins->z[entry] = scene->sphere_z[index];
+					bins->c[entry] = scene->sphere_c[index];
+
+				}
+
+			}
+
+		}
+
+	}
+
+	free(ranges);
+	free(cursor);
+
+	return bins;
+
+}
+
+
+/**
+ * tilebin_free
+ *
+ * @param bins - bins built by tilebin_build
+ * @returns void
+ * @description releases the bins and their gathered geometry
+ */
+void tilebin_free(TileBins *bins) {
+	free(bins->start);
+	free(bins->sphere);
+	free(bins->x);
+	free(bins->y);
+	free(bins->z);
+	free(bins->c);
+	free(bins->x_single);
+	free(bins->y_single);
+	free(bins->z_single);
+	free(bins->c_single);
+	free(bins);
+
+}
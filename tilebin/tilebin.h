@@ -0,0 +1,37 @@
+/**
+ * Author: agent
+ * Email: agent@local
+ * Date: Saturday, October 17, 2026
+ * File: tilebin.h
+ * Copyright © 2026 All rights reserved
+ */
+
+#ifndef tilebin_h
+#define tilebin_h
+
+/**
+ * TileBins
+ *
+ * @description the spheres each screen tile of an image can see. Tile i of the tiles_x by tiles_y
+ * grid of tile_size square tiles, in row order, lists its candidates at [start[i], start[i + 1]).
+ * sphere holds a candidate's index in the scene's sphere columns, and the candidate's center and
+ * prepared constant are gathered next to it so a tile's list streams through the packet kernels.
+ * The gathered geometry is single precision, in the x_single columns, when the scene renders in
+ * single precision, and double precision otherwise.
+ */
+typedef struct TileBins {
+	int width, height, tile_size;
+	int tiles_x, tiles_y;
+	int num_entries;
+	int *start;
+	int *sphere;
+	double *x, *y, *z, *c;
+	float *x_single, *y_single, *z_single, *c_single;
+
+} TileBins;
+
+// function declarations
+TileBins *tilebin_build(RenderScene *scene, int width, int height, int tile_size);
+void tilebin_free(TileBins *bins);
+
+#endif